@@ -0,0 +1,6 @@
+if(CUSTOM_WITH_LUAJIT)
+	# Scripts run on the Lua states created by nCine, no other runtime is linked.
+	# The FFI functions are only exposed at run time if nCine has been built against LuaJIT.
+	message(STATUS "Scripts can access sprite vertices through the FFI when nCine runs them with LuaJIT")
+	target_compile_definitions(${NCPROJECT_EXE_NAME} PRIVATE "WITH_LUAJIT")
+endif()
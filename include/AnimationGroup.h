@@ -19,6 +19,15 @@ class AnimationGroup : public IAnimation
 
 	void stop() override;
 
+	/// Updates the group before its children, returns false if they should not be updated in this frame
+	/*! The animation plan calls it directly, together with `endUpdate()`, passing the precomputed ancestry */
+	virtual bool beginUpdate(float deltaTime, bool isInsideSequential) = 0;
+	/// Updates the group after its children have been updated
+	virtual void endUpdate(bool isInsideSequential) = 0;
+
+	/// Notifies the group that its animations have been added, removed, moved, enabled or disabled
+	virtual void invalidateAnims() {}
+
   protected:
 	LoopComponent loop_;
 	nctl::Array<nctl::UniquePtr<IAnimation>> anims_;
@@ -6,12 +6,16 @@
 
 class Sprite;
 class Script;
+class ScriptAnimation;
+class AnimationPlan;
+class AnimationTimeline;
 
 /// The animation manager class
 class AnimationManager
 {
   public:
 	AnimationManager();
+	~AnimationManager();
 
 	inline AnimationGroup &animGroup() { return *animGroup_; }
 	inline const AnimationGroup &animGroup() const { return *animGroup_; }
@@ -30,13 +34,26 @@ class AnimationManager
 	inline void play() { animGroup_->play(); }
 
 	void update(float deltaTime);
+	/// Stops all animations and applies their state at the specified time since the beginning of playback
+	/*! The state is computed directly, without updating the animations through all the previous frames.
+	 *  Scripts can keep their own state, so a tree with enabled script animations is instead played from the start,
+	 *  running their `init` functions, and updated in steps of the specified time, like when rendering. */
+	void evaluateAt(float time, float stepTime);
+	/// Returns the time in seconds needed to play all animations once, or infinity if they loop
+	float duration() const;
 	void clear();
 
+	/// Marks the evaluation plan as outdated, to be called after every change to the animation tree structure
+	/*! Animation groups are notified as well, as they keep tables of their enabled animations */
+	void invalidatePlan();
+
 	void removeAnimation(IAnimation *anim);
 	void removeSprite(Sprite *sprite);
 	void assignGridAnchorToParameters(Sprite *sprite);
 	void removeScript(Script *script);
 	void reloadScript(Script *script);
+	/// Appends to the array all the script animations that run the specified script
+	void retrieveScriptAnimations(const Script *script, nctl::Array<ScriptAnimation *> &scriptAnims);
 	void initScriptsForSprite(Sprite *sprite);
 	void overrideSprite(AnimationGroup &animGroup, Sprite *sprite);
 	void cloneSpriteAnimations(const Sprite *fromSprite, Sprite *toSprite);
@@ -44,6 +61,12 @@ class AnimationManager
   private:
 	float speedMultiplier_;
 	nctl::UniquePtr<AnimationGroup> animGroup_;
+
+	/// The flattened animation tree used to update the animations
+	nctl::UniquePtr<AnimationPlan> plan_;
+	bool planIsValid_;
+
+	nctl::UniquePtr<AnimationTimeline> timeline_;
 };
 
 #endif
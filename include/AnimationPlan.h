@@ -0,0 +1,47 @@
+#ifndef CLASS_ANIMATIONPLAN
+#define CLASS_ANIMATIONPLAN
+
+#include <nctl/Array.h>
+
+class IAnimation;
+class AnimationGroup;
+class CurveAnimation;
+
+/// A flat evaluation order compiled from the animation tree
+/*! The plan only needs to be rebuilt when the tree structure changes */
+class AnimationPlan
+{
+  public:
+	AnimationPlan();
+
+	inline unsigned int numNodes() const { return nodes_.size(); }
+
+	/// Flattens the tree rooted at the specified group
+	void build(AnimationGroup &root);
+	/// Updates all the animations in the same order and with the same semantics of the tree update
+	void update(float deltaTime);
+
+  private:
+	struct Node
+	{
+		IAnimation *anim = nullptr;
+		/// Not `nullptr` if the node is a group
+		AnimationGroup *group = nullptr;
+		/// Not `nullptr` if the node is a curve animation
+		CurveAnimation *curveAnim = nullptr;
+		/// Index of the first node that does not belong to this subtree
+		unsigned int end = 0;
+		bool isInsideSequential = false;
+		bool isParentSequential = false;
+	};
+
+	/// Nodes in depth-first order, children always follow their parent
+	nctl::Array<Node> nodes_;
+	/// Indices of the groups whose children are being updated
+	nctl::Array<unsigned int> openGroups_;
+
+	void addNodes(IAnimation &anim, bool isInsideSequential, bool isParentSequential);
+	void closeGroup();
+};
+
+#endif
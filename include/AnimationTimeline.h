@@ -0,0 +1,53 @@
+#ifndef CLASS_ANIMATIONTIMELINE
+#define CLASS_ANIMATIONTIMELINE
+
+#include <nctl/Array.h>
+
+class IAnimation;
+class AnimationGroup;
+class CurveAnimation;
+
+/// A closed form evaluator of the animation tree at an arbitrary point in time
+/*! Delays, loop delays, rewinding and ping-pong curves and groups are computed
+ *  directly from the elapsed time, without stepping through the previous frames. */
+class AnimationTimeline
+{
+  public:
+	AnimationTimeline();
+
+	/// Returns the time in seconds needed to play the animation once, or infinity if it never stops
+	static float duration(const IAnimation &anim);
+
+	/// Applies to the sprites the state of the tree after playing it from the start for the specified time
+	/*! The tree is expected to be stopped, as it is when the evaluation begins */
+	void evaluate(AnimationGroup &root, float time);
+
+  private:
+	struct Entry
+	{
+		CurveAnimation *anim = nullptr;
+		/// Curve time at the evaluated instant
+		float time = 0.0f;
+		/// Timeline instant at which the current run of the animation began
+		float startTime = 0.0f;
+		/// Order of the animation in the tree, to break ties between equal start times
+		unsigned int order = 0;
+	};
+
+	/// Animations that have not started yet
+	nctl::Array<CurveAnimation *> restingAnims_;
+	/// Animations that are running or have already finished
+	nctl::Array<Entry> runningAnims_;
+
+	static float duration(const IAnimation &anim, bool reversed, bool isInsideSequential);
+	/// Returns the time needed by the enabled animations of a group to play once, or a negative number if there are none
+	static float passLength(const AnimationGroup &animGroup, bool reversed, bool isInsideSequential);
+
+	void evaluateAnim(IAnimation &anim, float time, float startTime, bool reversed, bool isInsideSequential);
+	void evaluateCurve(CurveAnimation &anim, float time, float startTime, bool reversed, bool isInsideSequential);
+	void evaluateGroup(AnimationGroup &animGroup, float time, float startTime, bool reversed, bool isInsideSequential);
+	void evaluatePass(AnimationGroup &animGroup, float time, float startTime, bool reversed, bool isInsideSequential);
+	void addResting(IAnimation &anim);
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+/// Micro-benchmarks run from the command line instead of starting the interface
+namespace Benchmarks {
+
+/// Compares the scalar and the vectorized grid kernels on different grid sizes and prints the results
+void gridKernels();
+/// Prints the accuracy and the speed of the easing curve lookup tables compared to the analytic evaluation
+void easingCurves();
+
+}
+
+#endif
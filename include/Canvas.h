@@ -9,19 +9,26 @@ namespace ncine {
 
 class GLTexture;
 class GLFramebufferObject;
+class GLBufferObject;
 
 }
 
 namespace nc = ncine;
 
+class PngSaverPool;
+
 /// The canvas texture to display the results
 class Canvas
 {
   public:
 	nc::Colorf backgroundColor;
 
+	/// The number of pixel pack buffers used to save frames without stalling
+	static const unsigned int NumPixelPackBuffers = 3;
+
 	Canvas();
 	Canvas(int width, int height);
+	~Canvas();
 
 	inline void resizeTexture(const nc::Vector2i &size) { resizeTexture(size.x, size.y); }
 	void resizeTexture(int width, int height);
@@ -34,7 +41,18 @@ class Canvas
 	void bind();
 	void unbind();
 
+	/// Reads back the canvas texture into a buffer of `texSizeInBytes()` bytes
+	void readPixels(unsigned char *dest);
 	void save(const char *filename);
+	/// Reads back the canvas texture and lets the pool encode it to a PNG file asynchronously
+	/*! On desktop the readback goes through a ring of pixel pack buffers and is only
+	 *  completed when the ring is full or when `finishSaves()` is called */
+	void save(const char *filename, PngSaverPool &saverPool);
+	/// Completes all the pending readbacks and hands them to the pool
+	void finishSaves(PngSaverPool &saverPool);
+	/// Drops all the pending readbacks without writing them
+	void discardSaves();
+	inline unsigned int numPendingSaves() const { return numPendingSaves_; }
 
 	inline int maxTextureSize() const { return maxTextureSize_; }
 
@@ -57,6 +75,14 @@ class Canvas
 	nctl::UniquePtr<nc::GLTexture> texture_;
 
 	nctl::UniquePtr<nc::GLFramebufferObject> fbo_;
+
+	struct PixelPackBuffer;
+	nctl::UniquePtr<PixelPackBuffer[]> pixelPackBuffers_;
+	unsigned int firstPendingSave_;
+	unsigned int numPendingSaves_;
+
+	void beginReadback(const char *filename);
+	void endReadback(PngSaverPool &saverPool);
 };
 
 #endif
@@ -12,7 +12,7 @@ namespace nc = ncine;
 /// The configuration to be loaded or saved
 struct Configuration
 {
-	const int version = 6;
+	const int version = 11;
 
 	int width = 1280;
 	int height = 720;
@@ -27,6 +27,14 @@ struct Configuration
 
 	int canvasWidth = 256;
 	int canvasHeight = 256;
+	bool batchSprites = true; // Added in version 7
+	bool instancedSprites = true; // Added in version 8
+	bool shaderGridFunctions = true; // Added in version 9
+	bool sharedScriptState = false; // Added in version 10
+	int scriptInstructionBudget = 100000000; // Added in version 11
+	bool scriptGenerationalGc = false; // Added in version 11
+	int scriptGcPause = 200; // Added in version 11
+	int scriptGcStepMultiplier = 100; // Added in version 11
 
 	bool autoGuiScaling = true; // Added in version 6
 #ifdef __ANDROID__
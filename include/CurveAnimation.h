@@ -19,6 +19,8 @@ class CurveAnimation : public IAnimation
 	void play() override;
 
 	void update(float deltaTime) override;
+	/// Updates the curve knowing if the animation is inside a sequential group, without walking up the tree
+	void updateCurve(float deltaTime, bool isInsideSequential);
 	virtual void perform() = 0;
 
 	inline const EasingCurve &curve() const { return curve_; }
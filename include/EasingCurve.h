@@ -1,6 +1,7 @@
 #ifndef CLASS_EASINGCURVE
 #define CLASS_EASINGCURVE
 
+#include <nctl/Array.h>
 #include "LoopComponent.h"
 
 /// The easing curve class
@@ -17,10 +18,28 @@ class EasingCurve
 		SINE,
 		EXPO,
 		CIRC,
+		KEYFRAMES,
 	};
 
+	/// A point of a keyframe curve, joined to the next one by a cubic Hermite segment
+	struct Keyframe
+	{
+		float time = 0.0f;
+		float value = 0.0f;
+		/// Slope of the curve when arriving at the keyframe
+		float inTangent = 0.0f;
+		/// Slope of the curve when leaving the keyframe
+		float outTangent = 0.0f;
+	};
+
+	/// Number of intervals of the lookup table of every curve type
+	static const unsigned int LookupTableSize = 1024;
+
 	EasingCurve(Type type, Loop::Mode loopMode);
 
+	/// Returns the maximum error of the lookup table of a curve type in the unit interval, before scale and shift
+	static float lookupTableMaxError(Type type);
+
 	inline Type type() const { return type_; }
 	inline void setType(Type type) { type_ = type; }
 
@@ -31,6 +50,19 @@ class EasingCurve
 	inline bool &hasInitialValue() { return withInitialValue_; }
 	inline void enableInitialValue(bool withInitialValue) { withInitialValue_ = withInitialValue; }
 
+	/// Returns true if the value is interpolated from a precomputed table when time is in the unit interval
+	inline bool hasLookupTable() const { return withLookupTable_; }
+	inline bool &hasLookupTable() { return withLookupTable_; }
+	inline void enableLookupTable(bool withLookupTable) { withLookupTable_ = withLookupTable; }
+
+	/// Returns the keyframes of a `KEYFRAMES` curve, sorted by time
+	inline const nctl::Array<Keyframe> &keyframes() const { return keyframes_; }
+	/// Inserts a keyframe keeping the array sorted by time and returns its index
+	unsigned int addKeyframe(const Keyframe &keyframe);
+	void removeKeyframe(unsigned int index);
+	/// Modifies a keyframe and moves it to keep the array sorted, returns its new index
+	unsigned int setKeyframe(unsigned int index, const Keyframe &keyframe);
+
 	inline float time() const { return time_; }
 	inline float &time() { return time_; }
 	void setTime(float time);
@@ -63,6 +95,7 @@ class EasingCurve
 	Type type_;
 	LoopComponent loop_;
 	bool withInitialValue_;
+	bool withLookupTable_;
 
 	float time_;
 	float initialValue_;
@@ -71,6 +104,23 @@ class EasingCurve
 
 	float scale_;
 	float shift_;
+
+	nctl::Array<Keyframe> keyframes_;
+	/// Index of the first keyframe of the segment that contains the current time
+	/*! It is only updated when the time changes, so that `value()` can be called from different threads */
+	unsigned int keyframeCursor_;
+
+	struct LookupTables;
+	static const LookupTables &lookupTables();
+
+	static float analyticValue(Type type, float time);
+	static float lookupTableValue(Type type, float time);
+	static float lookupTableValue(const float *values, float time);
+
+	/// Returns the index of the first keyframe of the segment that contains the specified time
+	unsigned int findKeyframeSegment(float time) const;
+	void updateKeyframeCursor();
+	float keyframeValue(float time) const;
 };
 
 #endif
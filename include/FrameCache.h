@@ -0,0 +1,61 @@
+#ifndef CLASS_FRAMECACHE
+#define CLASS_FRAMECACHE
+
+#include <nctl/UniquePtr.h>
+#include <nctl/Array.h>
+
+namespace ncine {
+
+class GLTexture;
+class GLFramebufferObject;
+
+}
+
+namespace nc = ncine;
+
+class Canvas;
+
+/// A bounded least recently used cache of rendered canvas frames kept on the GPU
+/*! Frames are identified by their index and by the project revision they were rendered with */
+class FrameCache
+{
+  public:
+	/// Creates a cache that never holds more than the specified amount of texture memory
+	explicit FrameCache(unsigned int maxBytes);
+	~FrameCache();
+
+	/// Returns the maximum number of frames with the size of the specified canvas
+	unsigned int capacity(const Canvas &canvas) const;
+	inline unsigned int numFrames() const { return numFrames_; }
+
+	/// Copies a cached frame to the canvas, returns false if it is not in the cache
+	bool restore(int frame, unsigned int revision, Canvas &canvas);
+	/// Copies the canvas to the cache, replacing the least recently used frame if the cache is full
+	void store(int frame, unsigned int revision, Canvas &canvas);
+	/// Forgets all the frames, keeping the textures to be reused
+	void clear();
+
+  private:
+	struct Entry
+	{
+		nctl::UniquePtr<nc::GLTexture> texture;
+		nctl::UniquePtr<nc::GLFramebufferObject> fbo;
+		int frame = -1;
+		/// The value of the use counter the last time the frame was stored or restored
+		unsigned long int lastUse = 0;
+	};
+
+	unsigned int maxBytes_;
+	/// The size of all the cached frames
+	int width_;
+	int height_;
+	unsigned int numFrames_;
+	/// The revision of all the cached frames
+	unsigned int revision_;
+	unsigned long int useCounter_;
+	nctl::Array<Entry> entries_;
+
+	int findFrame(int frame) const;
+};
+
+#endif
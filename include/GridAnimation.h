@@ -32,6 +32,16 @@ class GridAnimation : public SpriteAnimation
   private:
 	const GridFunction *gridFunction_;
 	nctl::Array<GridFunctionParameter> params_;
+
+	/// True if the last inputs have been stored
+	bool hasLastInputs_;
+	/// Curve value of the last perform
+	float lastValue_;
+	/// Parameters of the last perform
+	nctl::Array<GridFunctionParameter> lastParams_;
+
+	/// Stores the current inputs and returns true if they differ from the last ones
+	bool updateLastInputs();
 };
 
 #endif
@@ -14,7 +14,8 @@ class GridFunction
 {
   public:
 	static const unsigned int MaxNameLength = 64;
-	using CallbackType = void (*)(GridAnimation &gridAnimation);
+	/// The callback deforms the vertex rows from `firstRow` up to `lastRow` excluded
+	using CallbackType = void (*)(GridAnimation &gridAnimation, int firstRow, int lastRow);
 
 	enum class ParameterType
 	{
@@ -78,12 +79,19 @@ class GridFunction
 
 	inline void setCallback(CallbackType callback) { callback_ = callback; }
 
+	/// Returns the function identifier in the grid vertex shader, or -1 if it can only run on the CPU
+	inline int shaderId() const { return shaderId_; }
+	inline void setShaderId(int shaderId) { shaderId_ = shaderId; }
+
 	void execute(GridAnimation &animation) const;
+	/// Deforms only a range of vertex rows, different ranges of the same sprite can be deformed concurrently
+	void execute(GridAnimation &animation, int firstRow, int lastRow) const;
 
   private:
 	nctl::String name_;
 	nctl::Array<ParameterInfo> parametersInfo_;
 	CallbackType callback_;
+	int shaderId_;
 };
 
 #endif
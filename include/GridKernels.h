@@ -0,0 +1,23 @@
+#ifndef GRIDKERNELS_H
+#define GRIDKERNELS_H
+
+#include <ncine/Vector2.h>
+#include "Sprite.h"
+
+namespace nc = ncine;
+
+/// Vectorized kernels used by the built-in grid functions
+namespace GridKernels {
+
+/// Adds `columnOffsets[column] + rowOffsets[row]` to the position of every vertex in a block of grid rows
+/*! Either offset array can be `nullptr`, the block has `verticesPerRow * numRows` vertices */
+void addOffsets(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets);
+/// Scalar version of `addOffsets()`, always available
+void addOffsetsScalar(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets);
+
+/// Returns the name of the instruction set used by `addOffsets()`
+const char *simdName();
+
+}
+
+#endif
@@ -15,6 +15,8 @@ class ParallelAnimationGroup : public AnimationGroup
 	void play() override;
 
 	void update(float deltaTime) override;
+	bool beginUpdate(float deltaTime, bool isInsideSequential) override;
+	void endUpdate(bool isInsideSequential) override;
 };
 
 #endif
@@ -0,0 +1,49 @@
+#ifndef CLASS_PNGSAVERPOOL
+#define CLASS_PNGSAVERPOOL
+
+#include <nctl/UniquePtr.h>
+#include <nctl/String.h>
+#include <ncine/IJobSystem.h>
+
+namespace nc = ncine;
+
+/// A bounded pool of recycled pixel buffers that are encoded to PNG files by the job system
+class PngSaverPool
+{
+  public:
+	/// Creates a pool with the specified number of buffers, or with two per job system thread if zero
+	explicit PngSaverPool(unsigned int numBuffers);
+	~PngSaverPool();
+
+	/// Returns a buffer for the next image, waiting for its previous encoding job if it is still running
+	/*! The same buffer is returned until `submit()` is called */
+	unsigned char *acquireBuffer(int width, int height);
+	/// Starts encoding the last acquired buffer to the specified PNG file
+	void submit(const char *filename);
+	/// Waits for all the encoding jobs to finish
+	void waitAll();
+
+	inline unsigned int numBuffers() const { return numBuffers_; }
+	unsigned int numPendingJobs() const;
+
+  private:
+	struct Buffer
+	{
+		nctl::UniquePtr<unsigned char[]> pixels;
+		unsigned int capacity = 0;
+		int width = 0;
+		int height = 0;
+		nctl::String filename = nctl::String(256);
+		nc::JobId jobId = {};
+		bool pending = false;
+	};
+
+	unsigned int numBuffers_;
+	unsigned int nextBuffer_;
+	nctl::UniquePtr<Buffer[]> buffers_;
+
+	void waitBuffer(Buffer &buffer);
+	static void encodeJob(nc::JobId job, const void *data);
+};
+
+#endif
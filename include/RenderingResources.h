@@ -18,6 +18,9 @@ class RenderingResources
   public:
 	static inline nc::GLShaderProgram *spriteShaderProgram() { return spriteShaderProgram_.get(); }
 	static inline nc::GLShaderProgram *meshSpriteShaderProgram() { return meshSpriteShaderProgram_.get(); }
+	static inline nc::GLShaderProgram *meshSpriteGridShaderProgram() { return meshSpriteGridShaderProgram_.get(); }
+	static inline nc::GLShaderProgram *batchedSpritesShaderProgram() { return batchedSpritesShaderProgram_.get(); }
+	static inline nc::GLShaderProgram *instancedSpritesShaderProgram() { return instancedSpritesShaderProgram_.get(); }
 	static inline const nc::Matrix4x4f &projectionMatrix() { return projectionMatrix_; }
 
 	static inline const nc::Vector2f &canvasSize() { return canvasSize_; }
@@ -29,6 +32,9 @@ class RenderingResources
   private:
 	static nctl::UniquePtr<nc::GLShaderProgram> spriteShaderProgram_;
 	static nctl::UniquePtr<nc::GLShaderProgram> meshSpriteShaderProgram_;
+	static nctl::UniquePtr<nc::GLShaderProgram> meshSpriteGridShaderProgram_;
+	static nctl::UniquePtr<nc::GLShaderProgram> batchedSpritesShaderProgram_;
+	static nctl::UniquePtr<nc::GLShaderProgram> instancedSpritesShaderProgram_;
 
 	static nc::Vector2f canvasSize_;
 	static nc::Matrix4x4f projectionMatrix_;
@@ -2,7 +2,9 @@
 #define CLASS_SCRIPT
 
 #include <nctl/String.h>
+#include <nctl/UniquePtr.h>
 #include <ncine/LuaStateManager.h>
+#include "ScriptProfile.h"
 
 struct lua_State;
 
@@ -14,8 +16,18 @@ namespace nc = ncine;
 class Script
 {
   public:
+	/// The functions a script animation can call
+	enum class Function
+	{
+		INIT,
+		UPDATE,
+
+		COUNT
+	};
+
 	Script();
 	explicit Script(const char *filename);
+	~Script();
 
 	inline bool canRun() const { return canRun_; }
 
@@ -24,6 +36,18 @@ class Script
 
 	inline const char *errorMsg() const { return errorMessage_.data(); }
 
+	/// Returns the name of a script function as defined in Lua
+	static const char *functionName(Function function);
+
+	/// Returns the statistics of the calls made to the script functions since the script was loaded
+	inline const ScriptProfile &profile() const { return profile_; }
+	inline void resetProfile() { profile_.reset(); }
+
+	/// Returns the state the script has been loaded into, or `nullptr` if it has not been loaded
+	inline lua_State *luaState() const { return state_; }
+	/// Returns true if the script is hosted by the state shared between scripts
+	inline bool isShared() const { return luaState_ == nullptr && state_ != nullptr; }
+
 	bool load(const char *filename);
 	bool reload();
 
@@ -31,9 +55,24 @@ class Script
 	bool canRun_;
 	nctl::String name_;
 	nctl::String errorMessage_;
-	nc::LuaStateManager luaState_;
+	/// The state owned by the script, unused when the script is hosted by the shared one
+	nctl::UniquePtr<nc::LuaStateManager> luaState_;
+	/// The state the script has been loaded into, either its own or the shared one
+	lua_State *state_;
+	/// True for each script function found when the script has been loaded
+	bool hasFunctions_[static_cast<int>(Function::COUNT)];
+	ScriptProfile profile_;
+
+	/// Returns the registry key of a script function, compiled once when the script is loaded
+	/*! The address of the function flag is unique among all the scripts hosted by the shared state */
+	inline void *functionKey(Function function) { return &hasFunctions_[static_cast<int>(function)]; }
 
 	bool run(const char *filename, const char *chunkName);
+	/// Compiles and runs the script in its own environment inside the shared state
+	bool runShared(const char *filename, const char *chunkName);
+	/// Stores in the registry each script function found in the table at the top of the stack
+	void retrieveFunctions(lua_State *L);
+	void releaseReferences();
 
 	friend class ScriptAnimation;
 };
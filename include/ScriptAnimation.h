@@ -2,8 +2,7 @@
 #define CLASS_SCRIPTANIMATION
 
 #include "SpriteAnimation.h"
-
-class Script;
+#include "Script.h"
 
 /// The script animation class
 class ScriptAnimation : public SpriteAnimation
@@ -25,10 +24,15 @@ class ScriptAnimation : public SpriteAnimation
 	inline Script *script() { return script_; }
 	void setScript(Script *script);
 
+	/// Returns the statistics of the script calls made by this animation
+	inline const ScriptProfile &profile() const { return profile_; }
+	inline void resetProfile() { profile_.reset(); }
+
   private:
 	Script *script_;
+	ScriptProfile profile_;
 
-	bool runScript(const char *functionName, float value);
+	bool runScript(Script::Function function, float value);
 };
 
 #endif
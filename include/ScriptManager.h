@@ -2,8 +2,16 @@
 #define CLASS_SCRIPTMANAGER
 
 #include <nctl/Array.h>
+#include <nctl/UniquePtr.h>
 
 struct lua_State;
+struct lua_Debug;
+
+namespace ncine {
+
+class LuaStateManager;
+
+}
 
 class Sprite;
 class Script;
@@ -14,7 +22,8 @@ namespace nc = ncine;
 class ScriptManager
 {
   public:
-	ScriptManager() {}
+	ScriptManager();
+	~ScriptManager();
 
 	inline nctl::Array<nctl::UniquePtr<Script>> &scripts() { return scripts_; }
 	inline const nctl::Array<nctl::UniquePtr<Script>> &scripts() const { return scripts_; }
@@ -23,15 +32,47 @@ class ScriptManager
 
 	int scriptIndex(const Script *script) const;
 
-	static void pushSprite(lua_State *L, Sprite *sprite);
+	/// Sets the sprite the script functions are going to operate on
+	static inline void setRunningSprite(Sprite *sprite) { runningSprite_ = sprite; }
+
+	/// Returns the state hosting all the scripts loaded when the shared state option is enabled
+	lua_State *sharedLuaState();
+
+	/// Applies the garbage collector settings of the configuration to the states of all loaded scripts
+	void applyGcSettings();
+	static void applyGcSettings(lua_State *L);
+
+	/// Limits the number of instructions the next script call can execute, as set in the configuration
+	/*! The counter is restarted on every invocation, a call that exceeds it raises a Lua error */
+	static void setInstructionBudget(lua_State *L);
+	/// Switches the LuaJIT compiler of all loaded scripts off while an instruction budget is set
+	void applyJitMode();
+	/// Switches the LuaJIT compiler off if an instruction budget is set, on otherwise
+	/*! Compiled traces do not call the count hook, so the budget can only be enforced by the interpreter.
+	 *  Nothing is done if the state has not been created by a LuaJIT runtime. */
+	static void applyJitMode(lua_State *L);
+	/// Returns true if the last call has been stopped for exceeding the instruction budget
+	static inline bool instructionBudgetExceeded() { return instructionBudgetExceeded_; }
 
   private:
+	/// The state hosting the scripts loaded with the shared state option, created on demand
+	nctl::UniquePtr<nc::LuaStateManager> sharedLuaState_;
 	nctl::Array<nctl::UniquePtr<Script>> scripts_;
 
-	static Sprite *retrieveSprite(lua_State *L);
+	static Sprite *runningSprite_;
+	static bool instructionBudgetExceeded_;
+
+	static void instructionBudgetHook(lua_State *L, lua_Debug *);
+
+	static inline Sprite *retrieveSprite(lua_State *) { return runningSprite_; }
 
 	static void exposeConstants(lua_State *L);
 	static void exposeFunctions(lua_State *L);
+#ifdef WITH_LUAJIT
+	/// Lets scripts access the sprite grid as native arrays through the LuaJIT FFI
+	/*! Nothing is exposed if the state has not been created by a LuaJIT runtime */
+	static void exposeFfiFunctions(lua_State *L);
+#endif
 
 	static int canvasWidth(lua_State *L);
 	static int canvasHeight(lua_State *L);
@@ -57,6 +98,8 @@ class ScriptManager
 	static int rgbBlendingPreset(lua_State *L);
 	static int alphaBlendingPreset(lua_State *L);
 	static int numVertices(lua_State *L);
+	static int gridWidth(lua_State *L);
+	static int gridHeight(lua_State *L);
 
 	static int vertices(lua_State *L);
 	static int verticesXY(lua_State *L);
@@ -65,6 +108,16 @@ class ScriptManager
 	static int verticesY(lua_State *L);
 	static int verticesU(lua_State *L);
 	static int verticesV(lua_State *L);
+	/// Returns a table with the `x`, `y`, `u` and `v` views of the sprite vertices, indexable like arrays
+	/*! Views read and write the vertices of the sprite the script is running on, without copying them */
+	static int vertexBuffer(lua_State *L);
+	static int vertexBufferIndex(lua_State *L);
+	static int vertexBufferNewIndex(lua_State *L);
+	static int vertexBufferLength(lua_State *L);
+#ifdef WITH_LUAJIT
+	static int verticesData(lua_State *L);
+	static int texCoordsData(lua_State *L);
+#endif
 
 	static int setPosition(lua_State *L);
 	static int setPositionX(lua_State *L);
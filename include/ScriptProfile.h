@@ -0,0 +1,36 @@
+#ifndef CLASS_SCRIPTPROFILE
+#define CLASS_SCRIPTPROFILE
+
+#include <cstdint>
+
+/// The execution statistics of the Lua functions run by a script or by a script animation
+struct ScriptProfile
+{
+	unsigned int numCalls = 0;
+	/// Cumulative time spent in the calls, in seconds
+	float totalTime = 0.0f;
+	/// Time spent in the slowest call, in seconds
+	float peakTime = 0.0f;
+	/// Cumulative difference in bytes of the memory used by the Lua state across the calls
+	int64_t memoryDelta = 0;
+	/// Number of calls after which the state used less memory than before
+	/*! It is an estimate of the garbage collector activity, not a count of its steps or cycles */
+	unsigned int callsFreeingMemory = 0;
+
+	inline float averageTime() const { return (numCalls > 0) ? totalTime / numCalls : 0.0f; }
+
+	inline void addCall(float time, int64_t callMemoryDelta)
+	{
+		numCalls++;
+		totalTime += time;
+		if (peakTime < time)
+			peakTime = time;
+		memoryDelta += callMemoryDelta;
+		if (callMemoryDelta < 0)
+			callsFreeingMemory++;
+	}
+
+	inline void reset() { *this = ScriptProfile(); }
+};
+
+#endif
@@ -7,6 +7,8 @@
 class SequentialAnimationGroup : public AnimationGroup
 {
   public:
+	SequentialAnimationGroup();
+
 	nctl::UniquePtr<IAnimation> clone() const override;
 
 	inline Type type() const override { return Type::SEQUENTIAL_GROUP; }
@@ -15,8 +17,29 @@ class SequentialAnimationGroup : public AnimationGroup
 	void play() override;
 
 	void update(float deltaTime) override;
+	bool beginUpdate(float deltaTime, bool isInsideSequential) override;
+	void endUpdate(bool isInsideSequential) override;
+
+	void invalidateAnims() override;
 
   private:
+	/// Index of the animation that was playing when the update began
+	int playingIndex_ = -1;
+	/// Index of the last animation played by the group, checked before searching all of them
+	int cursor_ = -1;
+
+	/// True if the enabled animation tables reflect the current animations
+	bool enabledAnimsAreValid_ = false;
+	int firstEnabled_ = -1;
+	int lastEnabled_ = -1;
+	/// For every animation, the index of the next enabled one, or the number of animations if there are none
+	nctl::Array<int> nextEnabled_;
+	/// For every animation, the index of the previous enabled one, or -1 if there are none
+	nctl::Array<int> previousEnabled_;
+
+	/// Returns the index of an animation in the specified state, or -1 if there are none
+	int findAnim(State state);
+	void updateEnabledAnims();
 	int nextPlayingIndex(int playingIndex);
 };
 
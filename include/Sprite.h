@@ -5,6 +5,7 @@
 #include <nctl/String.h>
 #include <ncine/Rect.h>
 #include <ncine/Matrix4x4.h>
+#include <ncine/Vector4.h>
 #include <ncine/Colorf.h>
 #include "SpriteEntry.h"
 
@@ -19,14 +20,21 @@ class GLBufferObject;
 namespace nc = ncine;
 
 class Texture;
+class GridAnimation;
 
 /// The sprite to animate
 class Sprite : public SpriteEntry
 {
   public:
+	/// Vertex position, deformed by grid animations
 	struct Vertex
 	{
 		float x, y;
+	};
+
+	/// Vertex texture coordinates, stored in a separate stream as they rarely change
+	struct TexCoords
+	{
 		float u, v;
 	};
 
@@ -40,6 +48,9 @@ class Sprite : public SpriteEntry
 	};
 
 	static const unsigned int MaxNameLength = 64;
+	static const int MaxGridCellSize = 64;
+	static const unsigned int MaxShaderGridFunctions = 8;
+	static const unsigned int GridFunctionShaderParams = 3;
 	nctl::String name;
 
 	bool visible;
@@ -57,7 +68,9 @@ class Sprite : public SpriteEntry
 
 	nctl::UniquePtr<Sprite> clone() const;
 
-	void transform();
+	/// Computes the world transformation and the absolute properties, returns true if they have changed
+	/*! The transformation is only computed again if the sprite properties or its parent have changed */
+	bool transform(bool parentChanged);
 	void updateRender();
 	void render();
 	void resetGrid();
@@ -68,6 +81,8 @@ class Sprite : public SpriteEntry
 	inline nc::Recti texRect() const { return texRect_; }
 	void setTexRect(const nc::Recti &texRect);
 	inline nc::Recti flippingTexRect() const { return flippingTexRect_; }
+	/// Returns the scale and bias to apply to normalized texture coordinates as `(scaleX, biasX, scaleY, biasY)`
+	nc::Vector4f texRectScaleBias() const;
 
 	inline const Texture &texture() const { return *texture_; }
 	inline Texture &texture() { return *texture_; }
@@ -87,13 +102,59 @@ class Sprite : public SpriteEntry
 	inline void setAlphaBlendingPreset(BlendingPreset alphaBlendingPreset) { alphaBlendingPreset_ = alphaBlendingPreset; }
 
 	inline const nctl::Array<Vertex> &vertexRestPositions() const { return restPositions_; }
-	inline const nctl::Array<Vertex> &interleavedVertices() const { return interleavedVertices_; }
-	inline nctl::Array<Vertex> &interleavedVertices() { return interleavedVertices_; }
+	inline const nctl::Array<Vertex> &vertices() const { return vertices_; }
+	inline nctl::Array<Vertex> &vertices() { return vertices_; }
+	inline const nctl::Array<TexCoords> &texCoords() const { return texCoords_; }
+	inline nctl::Array<TexCoords> &texCoords() { return texCoords_; }
 
 	void *imguiTexId();
 
 	void incrementGridAnimCounter();
 	void decrementGridAnimCounter();
+	/// Script animations also count as grid animations, as they can modify vertices
+	void incrementScriptAnimCounter();
+	void decrementScriptAnimCounter();
+
+	/// Returns true if built-in grid functions can be evaluated by the grid vertex shader
+	bool usesShaderGrid() const;
+	/// Adds a built-in grid function to be evaluated by the vertex shader in the next draw
+	/*! \return False if the maximum number of functions has been reached */
+	bool addShaderGridFunction(int shaderId, float value, const float params[GridFunctionShaderParams]);
+	/// Returns true if grid animations are applied before drawing, reusing the last deformation if nothing changed
+	inline bool defersGridAnimations() const { return scriptAnimationsCounter_ == 0; }
+	/// Queues a grid animation to be applied to the vertices before the next draw
+	void queueGridAnimation(GridAnimation *gridAnimation, bool inputsChanged);
+	/// Removes a grid animation that was queued for the next draw
+	void dequeueGridAnimation(GridAnimation *gridAnimation);
+	/// Returns true if the queued grid animations are not the same as the last frame or their inputs have changed
+	bool gridNeedsUpdate() const;
+	/// Resets a range of vertex rows and applies the queued grid animations to it
+	/*! Different ranges of the same sprite can be deformed concurrently */
+	void deformGridRows(int firstRow, int lastRow);
+	/// Prepares the grid animations queue for the next frame, after the rows have been deformed if needed
+	void commitGrid(bool deformed);
+	/// Signals that the vertices have been modified on the CPU and need to be uploaded
+	inline void markVerticesModified()
+	{
+		verticesModified_ = true;
+		vboHoldsVertices_ = false;
+	}
+	/// Signals that the texture coordinates have been modified on the CPU and need to be uploaded
+	inline void markTexCoordsModified() { texCoordsModified_ = true; }
+	/// Returns true if the sprite is rendered as a deformable grid of vertices
+	inline bool isMeshSprite() const { return gridAnimationsCounter_ > 0; }
+
+	/// Returns the size in texels of a grid cell, a value of one creates a vertex for every texel
+	inline int gridCellSize() const { return gridCellSize_; }
+	void setGridCellSize(int gridCellSize);
+	/// Returns the number of grid cells along the X axis, there are `gridWidth() + 1` vertices per row
+	inline int gridWidth() const { return gridWidth_; }
+	/// Returns the number of grid cells along the Y axis, there are `gridHeight() + 1` vertices per column
+	inline int gridHeight() const { return gridHeight_; }
+	/// Returns the texel coordinate of a grid column, the last one lies on the sprite edge
+	inline int gridTexelX(int column) const { return (column * gridCellSize_ < width_) ? column * gridCellSize_ : width_; }
+	/// Returns the texel coordinate of a grid row, the last one lies on the sprite edge
+	inline int gridTexelY(int row) const { return (row * gridCellSize_ < height_) ? row * gridCellSize_ : height_; }
 
 	inline const nctl::Array<Sprite *> children() const { return children_; }
 	inline const Sprite *parent() const { return parent_; }
@@ -110,6 +171,7 @@ class Sprite : public SpriteEntry
 	inline const nc::Vector2f &absScaleFactor() const { return absScaleFactor_; }
 	inline float absRotation() const { return absRotation_; }
 	inline const nc::Colorf &absColor() const { return absColor_; }
+	inline const nc::Matrix4x4f &worldMatrix() const { return worldMatrix_; }
 
   private:
 	int width_;
@@ -123,6 +185,20 @@ class Sprite : public SpriteEntry
 	float absRotation_;
 	nc::Colorf absColor_;
 
+	/// Sprite properties used to compute the current transformation
+	struct TransformProperties
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float rotation = 0.0f;
+		nc::Vector2f scaleFactor;
+		nc::Vector2f anchorPoint;
+		nc::Colorf color;
+	};
+	TransformProperties lastTransform_;
+	/// True if the transformation needs to be computed again even if the properties have not changed
+	bool transformDirty_;
+
 	Texture *texture_;
 	nc::Recti texRect_;
 	/// Texture rectangle that takes flipping into account
@@ -135,16 +211,42 @@ class Sprite : public SpriteEntry
 	BlendingPreset alphaBlendingPreset_;
 
 	int gridAnimationsCounter_;
+	int scriptAnimationsCounter_;
+	int gridCellSize_;
+	int gridWidth_;
+	int gridHeight_;
 
-	nctl::Array<Vertex> interleavedVertices_;
+	nctl::Array<Vertex> vertices_;
 	nctl::Array<Vertex> restPositions_;
+	nctl::Array<TexCoords> texCoords_;
+	nctl::Array<TexCoords> restTexCoords_;
 	nctl::Array<unsigned int> indices_;
 	nctl::Array<unsigned short> shortIndices_;
+	/// True if the vertices differ from the rest positions
+	bool verticesModified_;
+	/// True if the vertex buffer contains the current vertices
+	bool vboHoldsVertices_;
+	/// True if the texture coordinates differ from the rest ones
+	bool texCoordsModified_;
+	/// True if the texture coordinates buffer contains the rest ones
+	bool vboHoldsRestTexCoords_;
+	/// Size in bytes of the vertex buffer storage
+	long int vboCapacity_;
+
+	/// Grid animations to apply before the next draw
+	nctl::Array<GridAnimation *> queuedGridAnims_;
+	/// Grid animations applied to the current vertices, only used for comparison
+	nctl::Array<GridAnimation *> lastGridAnims_;
+	/// True if the inputs of at least one of the queued grid animations have changed
+	bool gridInputsChanged_;
+
+	unsigned int numShaderGridFunctions_;
+	float shaderGridFunctions_[MaxShaderGridFunctions * 8];
 
 	Sprite *parent_;
 	nctl::Array<Sprite *> children_;
 
-	static const int UniformsBufferSize = 256;
+	static const int UniformsBufferSize = 512;
 	unsigned char uniformsBuffer_[UniformsBufferSize];
 
 	nc::GLShaderProgram *spriteShaderProgram_;
@@ -153,11 +255,21 @@ class Sprite : public SpriteEntry
 	nc::GLShaderProgram *meshSpriteShaderProgram_;
 	nctl::UniquePtr<nc::GLShaderUniforms> meshSpriteShaderUniforms_;
 
+	nc::GLShaderProgram *meshSpriteGridShaderProgram_;
+	nctl::UniquePtr<nc::GLShaderUniforms> meshSpriteGridShaderUniforms_;
+	int numGridFunctionsLocation_;
+	int gridFunctionsLocation_;
+	int meshTexCoordsLocation_;
+	int meshGridTexCoordsLocation_;
+
 	nctl::UniquePtr<nc::GLBufferObject> vbo_;
+	nctl::UniquePtr<nc::GLBufferObject> texCoordsVbo_;
 	nctl::UniquePtr<nc::GLBufferObject> ibo_;
 
 	void setSize(int width, int height);
 	void initGrid(int width, int height);
+	void restoreRestPositions();
+	void uploadVertices();
 	void resetVertices();
 	void resetIndices();
 
@@ -0,0 +1,95 @@
+#ifndef CLASS_SPRITEBATCHER
+#define CLASS_SPRITEBATCHER
+
+#include <nctl/Array.h>
+#include <nctl/UniquePtr.h>
+#include "Sprite.h"
+
+namespace ncine {
+
+class GLShaderProgram;
+class GLShaderUniforms;
+class GLBufferObject;
+
+}
+
+namespace nc = ncine;
+
+class Texture;
+
+/// The class that merges consecutive sprites sharing the same texture and blending into a single draw call
+class SpriteBatcher
+{
+  public:
+	SpriteBatcher();
+	~SpriteBatcher();
+
+	inline bool isInstancing() const { return instancing_; }
+	/// Draws batches with one instance per sprite instead of six transformed vertices
+	/*! The change only takes effect when the current batch is empty */
+	void setInstancing(bool instancing);
+
+	inline bool isEmpty() const { return numSprites_ == 0; }
+	inline unsigned int numSprites() const { return numSprites_; }
+
+	/// Returns true if the sprite can be appended to the current batch without breaking it
+	bool canAppend(const Sprite &sprite) const;
+	/// Appends the sprite to the current batch, as transformed vertices or as instance attributes
+	void append(Sprite &sprite);
+
+	inline Sprite::BlendingPreset rgbBlendingPreset() const { return rgbBlendingPreset_; }
+	inline Sprite::BlendingPreset alphaBlendingPreset() const { return alphaBlendingPreset_; }
+
+	/// Uploads and draws the current batch, then starts a new one
+	void flush();
+
+  private:
+	struct Vertex
+	{
+		float x, y;
+		float u, v;
+		float r, g, b, a;
+	};
+
+	struct Instance
+	{
+		float transform[4];
+		float positionSize[4];
+		float texRect[4];
+		float color[4];
+	};
+
+	static const unsigned int VerticesPerSprite = 6;
+	static const unsigned int NumInstanceAttributes = 4;
+
+	bool instancing_;
+	Texture *texture_;
+	Sprite::BlendingPreset rgbBlendingPreset_;
+	Sprite::BlendingPreset alphaBlendingPreset_;
+	unsigned int numSprites_;
+
+	nctl::Array<Vertex> vertices_;
+	nctl::Array<Instance> instances_;
+
+	static const int UniformsBufferSize = 128;
+	unsigned char uniformsBuffer_[UniformsBufferSize];
+
+	nc::GLShaderProgram *shaderProgram_;
+	nctl::UniquePtr<nc::GLShaderUniforms> shaderUniforms_;
+
+	unsigned char instancedUniformsBuffer_[UniformsBufferSize];
+	nc::GLShaderProgram *instancedShaderProgram_;
+	nctl::UniquePtr<nc::GLShaderUniforms> instancedShaderUniforms_;
+	int instanceAttributeLocations_[NumInstanceAttributes];
+
+	nctl::UniquePtr<nc::GLBufferObject> vbo_;
+	long int vboCapacity_;
+
+	void appendVertices(const Sprite &sprite);
+	void appendInstance(const Sprite &sprite);
+	void uploadVbo(const void *data, long int bytes);
+	void drawVertices();
+	void drawInstances();
+};
+
+#endif
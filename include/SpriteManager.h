@@ -2,17 +2,22 @@
 #define CLASS_SPRITEMANAGER
 
 #include <nctl/Array.h>
+#include <ncine/IJobSystem.h>
 
 class SpriteEntry;
 class SpriteGroup;
 class Sprite;
 class Texture;
+class SpriteBatcher;
+
+namespace nc = ncine;
 
 /// The sprite manager class
 class SpriteManager
 {
   public:
 	SpriteManager();
+	~SpriteManager();
 
 	inline nctl::Array<nctl::UniquePtr<Texture>> &textures() { return textures_; }
 	inline const nctl::Array<nctl::UniquePtr<Texture>> &textures() const { return textures_; }
@@ -27,6 +32,8 @@ class SpriteManager
 	inline const nctl::Array<Sprite *> &sprites() const { return spritesArray_; }
 
 	void updateSpritesArray();
+	/// Marks the list of sprites without a parent as outdated, to be called when a sprite changes parent
+	inline void invalidateSpritesWithoutParent() { spritesWithoutParentAreValid_ = false; }
 	void update();
 
 	int textureIndex(const Texture *texture) const;
@@ -40,10 +47,22 @@ class SpriteManager
 	nctl::UniquePtr<SpriteGroup> root_;
 
 	nctl::Array<Sprite *> spritesWithoutParent_;
+	/// True if the sprites without a parent have been collected after the last change to the sprites or their parents
+	bool spritesWithoutParentAreValid_;
 	nctl::Array<Sprite *> spritesArray_;
 
-	void transform(Sprite *sprite);
+	nctl::UniquePtr<SpriteBatcher> batcher_;
+
+	/// Visible sprites whose grid needs to be deformed in the current frame
+	nctl::Array<Sprite *> gridSprites_;
+	nctl::Array<nc::JobId> gridJobs_;
+
+	/// Transforms a sprite and its children, the ones that have not changed are skipped
+	void transform(Sprite *sprite, bool parentChanged);
+	/// Deforms the grids of all visible sprites, splitting the work into jobs when it is large enough
+	void updateGrids();
 	void draw(Sprite *sprite);
+	void flushBatch();
 };
 
 #endif
@@ -1,10 +1,13 @@
 #ifndef CLASS_ANIMATIONWINDOW
 #define CLASS_ANIMATIONWINDOW
 
+#include <nctl/Array.h>
+
 class UserInterface;
 class IAnimation;
 class AnimationGroup;
 class LoopComponent;
+class EasingCurve;
 class CurveAnimation;
 class PropertyAnimation;
 class GridAnimation;
@@ -29,10 +32,17 @@ class AnimationWindow
   private:
 	UserInterface &ui_;
 
+	/// The curve the keyframe row IDs have been assigned for
+	const EasingCurve *keyframesCurve_;
+	/// The ImGui IDs of the keyframe rows, moved together with the keyframes when they are sorted again
+	nctl::Array<int> keyframeIds_;
+	int nextKeyframeId_;
+
 	void createDelayAnimationGui(IAnimation &anim);
 	void createLoopAnimationGui(LoopComponent &loop);
 	void createOverrideSpriteGui(AnimationGroup &animGroup);
 	void createCurveAnimationGui(CurveAnimation &anim, const CurveAnimationGuiLimits &limits);
+	void createKeyframesGui(EasingCurve &curve);
 	void createPropertyAnimationGui(PropertyAnimation &anim);
 	void createGridAnimationGui(GridAnimation &anim);
 	void createScriptAnimationGui(ScriptAnimation &anim);
@@ -1,18 +1,26 @@
 #ifndef CLASS_ANIMATIONSWINDOW
 #define CLASS_ANIMATIONSWINDOW
 
+#include <nctl/UniquePtr.h>
+
 class UserInterface;
 class AnimationGroup;
 class IAnimation;
+class FrameCache;
 
 /// The animations window class
 class AnimationsWindow
 {
   public:
 	explicit AnimationsWindow(UserInterface &ui);
+	~AnimationsWindow();
 
 	void create();
 
+	inline bool isScrubbing() const { return isScrubbing_; }
+	/// Shows on the canvas the frame at the scrubber position, rendering it only if it is not in the cache
+	void renderScrubbedFrame(unsigned int projectRevision);
+
   private:
 	struct DragAnimationPayload
 	{
@@ -22,7 +30,12 @@ class AnimationsWindow
 
 	UserInterface &ui_;
 
+	bool isScrubbing_;
+	int scrubbedFrame_;
+	nctl::UniquePtr<FrameCache> frameCache_;
+
 	void removeAnimation();
+	void createTimeline();
 	void createAnimationListEntry(IAnimation &anim, unsigned int index, unsigned int &animId);
 };
 
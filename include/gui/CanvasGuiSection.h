@@ -11,7 +11,8 @@ class Canvas;
 class CanvasGuiSection
 {
   public:
-	void create(Canvas &canvas);
+	/// Returns true if the background color or the size of the canvas have been changed
+	bool create(Canvas &canvas);
 
 	void setResize(const nc::Vector2i &size);
 	void setResize(int width, int height);
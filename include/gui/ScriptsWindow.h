@@ -1,7 +1,11 @@
 #ifndef CLASS_SCRIPTSWINDOW
 #define CLASS_SCRIPTSWINDOW
 
+#include <nctl/Array.h>
+
 class UserInterface;
+class ScriptAnimation;
+struct ScriptProfile;
 
 /// The scripts window class
 class ScriptsWindow
@@ -15,8 +19,12 @@ class ScriptsWindow
 
   private:
 	UserInterface &ui_;
+	/// The script animations of the selected script, shown by the profiler
+	nctl::Array<ScriptAnimation *> scriptAnims_;
 
 	void removeScript();
+	void createProfilerGui();
+	void createProfileRow(const char *name, const ScriptProfile &profile);
 };
 
 #endif
@@ -35,6 +35,8 @@ class UserInterface
 	bool shouldSaveSpritesheet() const;
 	void signalFrameSaved();
 	void cancelRender();
+	bool isScrubbing() const;
+	void renderScrubbedFrame();
 	void changeScalingFactor(float factor);
 	void openVideoModePopup();
 
@@ -71,6 +73,10 @@ class UserInterface
 	bool deleteKeyPressed_ = false;
 	bool enableKeyboardNav_ = true;
 	int numFrames_ = 0;
+	/// Incremented at every change that might modify the rendered frames
+	unsigned int projectRevision_ = 0;
+	/// Discards the frames cached by the timeline, to be called after an edit that changes the rendered frames
+	inline void invalidateFrames() { projectRevision_++; }
 
 #ifdef WITH_FONTAWESOME
 	/// Memory buffer for the FontAwesome icons font
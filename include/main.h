@@ -34,6 +34,9 @@ class MyEventHandler :
 
   private:
 	nctl::UniquePtr<UserInterface> ui_;
+
+	/// Renders and saves the next frame of the animation being exported
+	void saveAnimFrame();
 };
 
 #endif
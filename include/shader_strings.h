@@ -7,4 +7,7 @@ struct ShaderStrings
 	static char const *const sprite_fs;
 	static char const *const meshsprite_vs;
 	static char const *const meshsprite_snap_vs;
+	static char const *const meshsprite_grid_vs;
+	static char const *const batchedsprites_vs;
+	static char const *const instancedsprites_vs;
 };
@@ -10,6 +10,7 @@ class AnimationManager;
 class UserInterface;
 class LuaSaver;
 class ScriptManager;
+class PngSaverPool;
 
 extern Configuration theCfg;
 extern nctl::UniquePtr<Canvas> theCanvas;
@@ -19,5 +20,6 @@ extern nctl::UniquePtr<SpriteManager> theSpriteMgr;
 extern nctl::UniquePtr<AnimationManager> theAnimMgr;
 extern nctl::UniquePtr<LuaSaver> theSaver;
 extern nctl::UniquePtr<ScriptManager> theScriptingMgr;
+extern nctl::UniquePtr<PngSaverPool> thePngSaverPool;
 
 #endif
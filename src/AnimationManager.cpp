@@ -1,4 +1,7 @@
+#include <cmath>
 #include "AnimationManager.h"
+#include "AnimationPlan.h"
+#include "AnimationTimeline.h"
 #include "ParallelAnimationGroup.h"
 #include "PropertyAnimation.h"
 #include "GridAnimation.h"
@@ -9,6 +12,16 @@
 
 namespace {
 
+void recursiveInvalidateAnims(AnimationGroup &animGroup)
+{
+	animGroup.invalidateAnims();
+	for (unsigned int i = 0; i < animGroup.anims().size(); i++)
+	{
+		if (animGroup.anims()[i]->isGroup())
+			recursiveInvalidateAnims(static_cast<AnimationGroup &>(*animGroup.anims()[i]));
+	}
+}
+
 void resetAnimation(IAnimation &anim)
 {
 	if (anim.isSprite())
@@ -165,6 +178,63 @@ void recursiveReloadScript(AnimationGroup &animGroup, Script *script)
 	}
 }
 
+void recursiveRetrieveScriptAnimations(AnimationGroup &animGroup, const Script *script, nctl::Array<ScriptAnimation *> &scriptAnims)
+{
+	for (unsigned int i = 0; i < animGroup.anims().size(); i++)
+	{
+		IAnimation &anim = *animGroup.anims()[i];
+
+		if (anim.isGroup())
+		{
+			AnimationGroup &innerGroup = static_cast<AnimationGroup &>(anim);
+			recursiveRetrieveScriptAnimations(innerGroup, script, scriptAnims);
+		}
+		else if (anim.type() == IAnimation::Type::SCRIPT)
+		{
+			ScriptAnimation &scriptAnim = static_cast<ScriptAnimation &>(anim);
+			if (scriptAnim.script() == script)
+				scriptAnims.pushBack(&scriptAnim);
+		}
+	}
+}
+
+bool recursiveHasScriptAnimations(const AnimationGroup &animGroup)
+{
+	for (unsigned int i = 0; i < animGroup.anims().size(); i++)
+	{
+		const IAnimation &anim = *animGroup.anims()[i];
+		if (anim.enabled == false)
+			continue;
+
+		if (anim.isGroup())
+		{
+			if (recursiveHasScriptAnimations(static_cast<const AnimationGroup &>(anim)))
+				return true;
+		}
+		else if (anim.type() == IAnimation::Type::SCRIPT)
+			return true;
+	}
+
+	return false;
+}
+
+void recursiveResetGrids(AnimationGroup &animGroup)
+{
+	for (unsigned int i = 0; i < animGroup.anims().size(); i++)
+	{
+		IAnimation &anim = *animGroup.anims()[i];
+
+		if (anim.isGroup())
+			recursiveResetGrids(static_cast<AnimationGroup &>(anim));
+		else if (anim.isSprite())
+		{
+			SpriteAnimation &spriteAnim = static_cast<SpriteAnimation &>(anim);
+			if (spriteAnim.sprite() != nullptr)
+				spriteAnim.sprite()->resetGrid();
+		}
+	}
+}
+
 void recursiveInitScriptsForSprite(AnimationGroup &animGroup, Sprite *sprite)
 {
 	for (unsigned int i = 0; i < animGroup.anims().size(); i++)
@@ -276,35 +346,90 @@ void recursiveCloneSpriteAnimations(AnimationGroup &animGroup, const Sprite *fro
 ///////////////////////////////////////////////////////////
 
 AnimationManager::AnimationManager()
-    : speedMultiplier_(1.0f), animGroup_(nctl::makeUnique<ParallelAnimationGroup>())
+    : speedMultiplier_(1.0f), animGroup_(nctl::makeUnique<ParallelAnimationGroup>()),
+      plan_(nctl::makeUnique<AnimationPlan>()), planIsValid_(false),
+      timeline_(nctl::makeUnique<AnimationTimeline>())
 {
 	animGroup_->name = "Root";
 }
 
+AnimationManager::~AnimationManager() = default;
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
 
 void AnimationManager::update(float deltaTime)
 {
-	animGroup_->update(deltaTime * speedMultiplier_);
+	if (planIsValid_ == false)
+	{
+		plan_->build(*animGroup_);
+		planIsValid_ = true;
+	}
+	plan_->update(deltaTime * speedMultiplier_);
+}
+
+void AnimationManager::evaluateAt(float time, float stepTime)
+{
+	// Stopping the tree restores the initial direction and curve time of every animation
+	animGroup_->stop();
+
+	if (recursiveHasScriptAnimations(*animGroup_) == false || stepTime <= 0.0f)
+	{
+		timeline_->evaluate(*animGroup_, time * speedMultiplier_);
+		return;
+	}
+
+	// Playing and updating the tree like the render does, so that script functions are called in the same order
+	const unsigned int numSteps = static_cast<unsigned int>(roundf(time / stepTime));
+	play();
+	// Grid functions of sprites with scripts modify the vertices in place, the draw restores them between two frames
+	recursiveResetGrids(*animGroup_);
+	update(0.0f);
+	for (unsigned int i = 0; i < numSteps; i++)
+	{
+		recursiveResetGrids(*animGroup_);
+		update(stepTime);
+	}
+	// Stopping does not change the sprites, it only leaves the tree ready for the next evaluation
+	animGroup_->stop();
+}
+
+float AnimationManager::duration() const
+{
+	if (speedMultiplier_ <= 0.0f)
+		return INFINITY;
+	return AnimationTimeline::duration(*animGroup_) / speedMultiplier_;
+}
+
+void AnimationManager::invalidatePlan()
+{
+	planIsValid_ = false;
+	recursiveInvalidateAnims(*animGroup_);
 }
 
 void AnimationManager::clear()
 {
 	animGroup_->anims().clear();
+	invalidatePlan();
 }
 
 void AnimationManager::removeAnimation(IAnimation *anim)
 {
 	if (anim != nullptr)
+	{
 		recursiveRemoveAnimation(*anim);
+		invalidatePlan();
+	}
 }
 
 void AnimationManager::removeSprite(Sprite *sprite)
 {
 	if (sprite != nullptr)
+	{
 		recursiveRemoveSprite(*animGroup_, sprite);
+		invalidatePlan();
+	}
 }
 
 void AnimationManager::assignGridAnchorToParameters(Sprite *sprite)
@@ -315,7 +440,10 @@ void AnimationManager::assignGridAnchorToParameters(Sprite *sprite)
 void AnimationManager::removeScript(Script *script)
 {
 	if (script != nullptr)
+	{
 		recursiveRemoveScript(*animGroup_, script);
+		invalidatePlan();
+	}
 }
 
 void AnimationManager::reloadScript(Script *script)
@@ -324,6 +452,12 @@ void AnimationManager::reloadScript(Script *script)
 		recursiveReloadScript(*animGroup_, script);
 }
 
+void AnimationManager::retrieveScriptAnimations(const Script *script, nctl::Array<ScriptAnimation *> &scriptAnims)
+{
+	if (script != nullptr)
+		recursiveRetrieveScriptAnimations(*animGroup_, script, scriptAnims);
+}
+
 void AnimationManager::initScriptsForSprite(Sprite *sprite)
 {
 	if (sprite != nullptr)
@@ -339,5 +473,8 @@ void AnimationManager::overrideSprite(AnimationGroup &animGroup, Sprite *sprite)
 void AnimationManager::cloneSpriteAnimations(const Sprite *fromSprite, Sprite *toSprite)
 {
 	if (fromSprite != nullptr && toSprite != nullptr && fromSprite != toSprite)
+	{
 		recursiveCloneSpriteAnimations(*animGroup_, fromSprite, toSprite);
+		invalidatePlan();
+	}
 }
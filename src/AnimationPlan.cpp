@@ -0,0 +1,99 @@
+#include "AnimationPlan.h"
+#include "AnimationGroup.h"
+#include "CurveAnimation.h"
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+AnimationPlan::AnimationPlan()
+    : nodes_(64), openGroups_(8)
+{
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void AnimationPlan::build(AnimationGroup &root)
+{
+	nodes_.clear();
+	addNodes(root, false, false);
+}
+
+void AnimationPlan::update(float deltaTime)
+{
+	openGroups_.clear();
+
+	unsigned int index = 0;
+	while (index < nodes_.size())
+	{
+		// Groups are updated again after all of their children
+		while (openGroups_.isEmpty() == false && index >= nodes_[openGroups_.back()].end)
+			closeGroup();
+
+		const Node &node = nodes_[index];
+		// The root group is always updated, like the tree update does
+		if (index > 0 && node.anim->enabled == false)
+		{
+			if (node.isParentSequential && node.anim->state() == IAnimation::State::PLAYING)
+				node.anim->stop();
+			index = node.end;
+			continue;
+		}
+
+		if (node.group)
+		{
+			if (node.group->beginUpdate(deltaTime, node.isInsideSequential))
+			{
+				openGroups_.pushBack(index);
+				index++;
+			}
+			else
+				index = node.end;
+		}
+		else
+		{
+			node.curveAnim->updateCurve(deltaTime, node.isInsideSequential);
+			index++;
+		}
+	}
+
+	while (openGroups_.isEmpty() == false)
+		closeGroup();
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void AnimationPlan::addNodes(IAnimation &anim, bool isInsideSequential, bool isParentSequential)
+{
+	const unsigned int index = nodes_.size();
+
+	Node node;
+	node.anim = &anim;
+	node.isInsideSequential = isInsideSequential;
+	node.isParentSequential = isParentSequential;
+	if (anim.isGroup())
+		node.group = static_cast<AnimationGroup *>(&anim);
+	else
+		node.curveAnim = static_cast<CurveAnimation *>(&anim);
+	nodes_.pushBack(node);
+
+	if (node.group)
+	{
+		const bool isSequential = (anim.type() == IAnimation::Type::SEQUENTIAL_GROUP);
+		for (unsigned int i = 0; i < node.group->anims().size(); i++)
+			addNodes(*node.group->anims()[i], isInsideSequential || isSequential, isSequential);
+	}
+
+	nodes_[index].end = nodes_.size();
+}
+
+void AnimationPlan::closeGroup()
+{
+	const Node &node = nodes_[openGroups_.back()];
+	node.group->endUpdate(node.isInsideSequential);
+	openGroups_.popBack();
+}
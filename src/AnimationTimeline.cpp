@@ -0,0 +1,319 @@
+#include <cmath>
+#include <nctl/algorithms.h>
+#include "AnimationTimeline.h"
+#include "AnimationGroup.h"
+#include "CurveAnimation.h"
+
+namespace {
+
+/// The position of an instant inside the repeating passes of a looping group
+struct Pass
+{
+	/// Index of the pass, zero for the first one
+	float index = 0.0f;
+	/// Time elapsed since the beginning of the pass, clamped to its length
+	float time = 0.0f;
+	/// Time at which the pass began
+	float startTime = 0.0f;
+	/// True if the pass is played in the opposite direction of the first one
+	bool reversed = false;
+};
+
+/// Locates an instant in a sequence of passes, each one after the first preceded by the loop delay
+/*! While waiting for the loop delay the animations have already been restarted for the next pass */
+Pass locatePass(float time, float length, float reversedLength, float loopDelay, Loop::Mode mode)
+{
+	Pass pass;
+	if (time < length || mode == Loop::Mode::DISABLED || std::isinf(length))
+	{
+		pass.time = fminf(time, length);
+		return pass;
+	}
+
+	const float loopTime = time - length;
+	if (mode == Loop::Mode::REWIND)
+	{
+		const float cycle = loopDelay + length;
+		const float numCycles = (cycle > 0.0f) ? floorf(loopTime / cycle) : 0.0f;
+		pass.index = numCycles + 1.0f;
+		pass.startTime = length + numCycles * cycle;
+		pass.time = fminf(fmaxf(time - pass.startTime - loopDelay, 0.0f), length);
+		return pass;
+	}
+
+	// A ping-pong cycle is made of a reversed and of a forward pass
+	const float cycle = 2.0f * loopDelay + reversedLength + length;
+	const float numCycles = (cycle > 0.0f && std::isinf(cycle) == false) ? floorf(loopTime / cycle) : 0.0f;
+	const float cycleTime = loopTime - numCycles * cycle;
+	pass.startTime = length + numCycles * cycle;
+	if (cycleTime < loopDelay + reversedLength)
+	{
+		pass.index = 2.0f * numCycles + 1.0f;
+		pass.time = fminf(fmaxf(cycleTime - loopDelay, 0.0f), reversedLength);
+		pass.reversed = true;
+	}
+	else
+	{
+		pass.index = 2.0f * numCycles + 2.0f;
+		pass.startTime += loopDelay + reversedLength;
+		pass.time = fminf(fmaxf(cycleTime - 2.0f * loopDelay - reversedLength, 0.0f), length);
+	}
+	return pass;
+}
+
+bool isGoingForward(const LoopComponent &loop, bool reversed)
+{
+	return (loop.direction() == Loop::Direction::FORWARD) != reversed;
+}
+
+/// Returns the curve time at which a run begins, as set by `EasingCurve::reset()`
+float initialTime(const EasingCurve &curve, bool forward)
+{
+	if (curve.hasInitialValue())
+		return curve.initialValue();
+	return forward ? curve.start() : curve.end();
+}
+
+/// Returns the time a backward curve waits before moving for the first time
+/*! The curve bounces on the end of its range on the first update, waiting for the loop delay like after a loop */
+float initialLoopDelay(const CurveAnimation &anim, bool forward, bool isInsideSequential)
+{
+	if (forward || isInsideSequential || anim.curve().hasInitialValue())
+		return 0.0f;
+	return anim.curve().loop().delay();
+}
+
+/// Returns the time needed to bring the curve from its initial time to the end of its range
+float firstPassLength(const CurveAnimation &anim, bool forward, bool isInsideSequential)
+{
+	const EasingCurve &curve = anim.curve();
+	const float initial = initialTime(curve, forward);
+	const float distance = forward ? curve.end() - initial : initial - curve.start();
+	if (distance <= 0.0f)
+		return 0.0f;
+	return (anim.speed() > 0.0f) ? initialLoopDelay(anim, forward, isInsideSequential) + distance / anim.speed() : INFINITY;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+AnimationTimeline::AnimationTimeline()
+    : restingAnims_(64), runningAnims_(64)
+{
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+float AnimationTimeline::duration(const IAnimation &anim)
+{
+	return duration(anim, false, false);
+}
+
+void AnimationTimeline::evaluate(AnimationGroup &root, float time)
+{
+	restingAnims_.clear();
+	runningAnims_.clear();
+
+	// The root group is always evaluated, like the tree update does
+	evaluateAnim(root, time, 0.0f, false, false);
+
+	// Locked animations show their initial state until they start, like when the tree is stopped
+	for (CurveAnimation *anim : restingAnims_)
+	{
+		if (anim->isLocked())
+			anim->perform();
+	}
+
+	// The most recently started animation is the last one to modify a property
+	nctl::sort(runningAnims_.begin(), runningAnims_.end(), [](const Entry &entry1, const Entry &entry2)
+	{
+		if (entry1.startTime != entry2.startTime)
+			return entry1.startTime < entry2.startTime;
+		return entry1.order < entry2.order;
+	});
+
+	for (const Entry &entry : runningAnims_)
+	{
+		entry.anim->curve().setTime(entry.time);
+		entry.anim->perform();
+	}
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+float AnimationTimeline::duration(const IAnimation &anim, bool reversed, bool isInsideSequential)
+{
+	if (anim.isGroup() == false)
+	{
+		const CurveAnimation &curveAnim = static_cast<const CurveAnimation &>(anim);
+		const LoopComponent &loop = curveAnim.curve().loop();
+		// A looping curve never stops, not even when its looping is disabled by a sequential group
+		if (loop.mode() != Loop::Mode::DISABLED)
+			return INFINITY;
+		return anim.delay() + firstPassLength(curveAnim, isGoingForward(loop, reversed), isInsideSequential);
+	}
+
+	const AnimationGroup &animGroup = static_cast<const AnimationGroup &>(anim);
+	const float length = passLength(animGroup, isGoingForward(animGroup.loop(), reversed) == false, isInsideSequential);
+
+	// A group without enabled animations stops as soon as its delay has passed
+	if (length < 0.0f)
+		return anim.delay();
+	else if (isInsideSequential == false && animGroup.loop().mode() != Loop::Mode::DISABLED)
+		return INFINITY;
+	return anim.delay() + length;
+}
+
+float AnimationTimeline::passLength(const AnimationGroup &animGroup, bool reversed, bool isInsideSequential)
+{
+	const bool isSequential = (animGroup.type() == IAnimation::Type::SEQUENTIAL_GROUP);
+
+	float length = -1.0f;
+	for (const nctl::UniquePtr<IAnimation> &childAnim : animGroup.anims())
+	{
+		if (childAnim->enabled == false)
+			continue;
+
+		const float childDuration = duration(*childAnim, reversed, isInsideSequential || isSequential);
+		if (length < 0.0f)
+			length = childDuration;
+		else
+			length = isSequential ? length + childDuration : fmaxf(length, childDuration);
+	}
+
+	return length;
+}
+
+void AnimationTimeline::evaluateAnim(IAnimation &anim, float time, float startTime, bool reversed, bool isInsideSequential)
+{
+	if (time < anim.delay())
+	{
+		addResting(anim);
+		return;
+	}
+
+	time -= anim.delay();
+	startTime += anim.delay();
+
+	if (anim.isGroup())
+		evaluateGroup(static_cast<AnimationGroup &>(anim), time, startTime, reversed, isInsideSequential);
+	else
+		evaluateCurve(static_cast<CurveAnimation &>(anim), time, startTime, reversed, isInsideSequential);
+}
+
+void AnimationTimeline::evaluateCurve(CurveAnimation &anim, float time, float startTime, bool reversed, bool isInsideSequential)
+{
+	const EasingCurve &curve = anim.curve();
+	const LoopComponent &loop = curve.loop();
+	const bool forward = isGoingForward(loop, reversed);
+	const float firstLength = firstPassLength(anim, forward, isInsideSequential);
+	const float initial = initialTime(curve, forward);
+
+	Entry entry;
+	entry.anim = &anim;
+	entry.order = runningAnims_.size();
+	entry.startTime = startTime;
+
+	const float range = curve.end() - curve.start();
+	if (time <= firstLength || isInsideSequential || loop.mode() == Loop::Mode::DISABLED || range <= 0.0f || anim.speed() <= 0.0f)
+	{
+		const float runningTime = fminf(time, firstLength) - initialLoopDelay(anim, forward, isInsideSequential);
+		const float distance = fmaxf(runningTime, 0.0f) * anim.speed();
+		entry.time = forward ? initial + distance : initial - distance;
+	}
+	else
+	{
+		// After the first pass every pass covers the whole range, preceded by the loop delay
+		const float cycle = loop.delay() + range / anim.speed();
+		const float loopTime = time - firstLength;
+		const float numCycles = floorf(loopTime / cycle);
+		const float cycleTime = loopTime - numCycles * cycle;
+		const float distance = fmaxf(cycleTime - loop.delay(), 0.0f) * anim.speed();
+		entry.startTime += firstLength + numCycles * cycle;
+
+		bool passForward = forward;
+		// The first loop of a ping-pong curve goes back in the opposite direction
+		if (loop.mode() == Loop::Mode::PING_PONG && fmodf(numCycles, 2.0f) < 1.0f)
+			passForward = !forward;
+		entry.time = passForward ? curve.start() + distance : curve.end() - distance;
+	}
+
+	runningAnims_.pushBack(entry);
+}
+
+void AnimationTimeline::evaluateGroup(AnimationGroup &animGroup, float time, float startTime, bool reversed, bool isInsideSequential)
+{
+	const bool childrenReversed = (isGoingForward(animGroup.loop(), reversed) == false);
+	const float length = passLength(animGroup, childrenReversed, isInsideSequential);
+	if (length < 0.0f)
+		return;
+
+	// Looping is disabled if the group is inside a sequential group
+	const Loop::Mode loopMode = isInsideSequential ? Loop::Mode::DISABLED : animGroup.loop().mode();
+	const float reversedLength = (loopMode == Loop::Mode::PING_PONG) ? passLength(animGroup, !childrenReversed, isInsideSequential) : length;
+	const Pass pass = locatePass(time, length, reversedLength, animGroup.loop().delay(), loopMode);
+
+	// Animations that have not been reached yet in this pass still show the end of the previous one
+	if (pass.index > 0.0f)
+	{
+		const bool previousReversed = (loopMode == Loop::Mode::PING_PONG) ? !pass.reversed : pass.reversed;
+		const float previousLength = previousReversed ? reversedLength : length;
+		const float previousStartTime = startTime + pass.startTime - animGroup.loop().delay() - previousLength;
+		evaluatePass(animGroup, previousLength, previousStartTime, childrenReversed != previousReversed, isInsideSequential);
+	}
+	evaluatePass(animGroup, pass.time, startTime + pass.startTime, childrenReversed != pass.reversed, isInsideSequential);
+}
+
+void AnimationTimeline::evaluatePass(AnimationGroup &animGroup, float time, float startTime, bool reversed, bool isInsideSequential)
+{
+	if (animGroup.type() == IAnimation::Type::PARALLEL_GROUP)
+	{
+		for (nctl::UniquePtr<IAnimation> &childAnim : animGroup.anims())
+		{
+			if (childAnim->enabled)
+				evaluateAnim(*childAnim, time, startTime, reversed, isInsideSequential);
+		}
+		return;
+	}
+
+	// A reversed pass of a sequential group plays the animations from the last one to the first one
+	const int numAnims = animGroup.anims().size();
+	float elapsedTime = 0.0f;
+	for (int i = 0; i < numAnims; i++)
+	{
+		IAnimation &childAnim = *animGroup.anims()[reversed ? numAnims - 1 - i : i];
+		if (childAnim.enabled == false)
+			continue;
+
+		if (time < elapsedTime)
+			addResting(childAnim);
+		else
+		{
+			const float childDuration = duration(childAnim, reversed, true);
+			evaluateAnim(childAnim, fminf(time - elapsedTime, childDuration), startTime + elapsedTime, reversed, true);
+			elapsedTime += childDuration;
+		}
+	}
+}
+
+void AnimationTimeline::addResting(IAnimation &anim)
+{
+	if (anim.isGroup())
+	{
+		AnimationGroup &animGroup = static_cast<AnimationGroup &>(anim);
+		for (nctl::UniquePtr<IAnimation> &childAnim : animGroup.anims())
+		{
+			if (childAnim->enabled)
+				addResting(*childAnim);
+		}
+	}
+	else
+		restingAnims_.pushBack(static_cast<CurveAnimation *>(&anim));
+}
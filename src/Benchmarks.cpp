@@ -0,0 +1,269 @@
+#include <cmath>
+#include <nctl/Array.h>
+#include <ncine/common_macros.h>
+#include <ncine/common_constants.h>
+#include <ncine/TimeStamp.h>
+#include "Benchmarks.h"
+#include "GridKernels.h"
+#include "EasingCurve.h"
+
+namespace {
+
+/// A sprite grid detached from any texture, with one texel per cell
+struct BenchmarkGrid
+{
+	nctl::Array<Sprite::Vertex> vertices;
+	nctl::Array<nc::Vector2f> rowOffsets;
+	nctl::Array<nc::Vector2f> columnOffsets;
+	int size = 0;
+
+	explicit BenchmarkGrid(int gridSize)
+	    : vertices((gridSize + 1) * (gridSize + 1)), rowOffsets(gridSize + 1), columnOffsets(gridSize + 1), size(gridSize)
+	{
+		for (int y = 0; y < size + 1; y++)
+		{
+			for (int x = 0; x < size + 1; x++)
+				vertices.pushBack(Sprite::Vertex{ static_cast<float>(x), static_cast<float>(y) });
+		}
+		rowOffsets.setSize(size + 1);
+		columnOffsets.setSize(size + 1);
+	}
+};
+
+const float Value = 0.25f;
+const float Amplitude = 10.0f;
+const float Frequency = 5.0f;
+const float Pivot = 0.0f;
+
+// The per-vertex loops of the built-in grid functions before the kernels were introduced
+
+void scalarWaveX(BenchmarkGrid &grid)
+{
+	const int halfHeight = grid.size / 2;
+	for (int row = 0; row < grid.size + 1; row++)
+	{
+		const int y = row;
+		const float distPyNorm = (halfHeight + Pivot - y) / halfHeight;
+		const float diff = distPyNorm * Amplitude * sinf(Value * 2.0f * nc::fPi + (Frequency * distPyNorm));
+		for (int column = 0; column < grid.size + 1; column++)
+		{
+			const unsigned int index = static_cast<unsigned int>(column + row * (grid.size + 1));
+			Sprite::Vertex &v = grid.vertices[index];
+			v.x += diff;
+		}
+	}
+}
+
+void scalarWaveY(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	for (int column = 0; column < grid.size + 1; column++)
+	{
+		const int x = column;
+		const float distPxNorm = (halfWidth + Pivot - x) / halfWidth;
+		const float diff = distPxNorm * Amplitude * sinf(Value * 2.0f * nc::fPi + (Frequency * distPxNorm));
+		for (int row = 0; row < grid.size + 1; row++)
+		{
+			const unsigned int index = static_cast<unsigned int>(column + row * (grid.size + 1));
+			Sprite::Vertex &v = grid.vertices[index];
+			v.y += diff;
+		}
+	}
+}
+
+void scalarSkewX(BenchmarkGrid &grid)
+{
+	const int halfHeight = grid.size / 2;
+	const float invWidth = 1.0f / float(grid.size);
+	for (int row = 0; row < grid.size + 1; row++)
+	{
+		const int y = row;
+		const float distPy = halfHeight + Pivot - y;
+		const float diff = -distPy * Value * invWidth;
+		for (int column = 0; column < grid.size + 1; column++)
+		{
+			const unsigned int index = static_cast<unsigned int>(column + row * (grid.size + 1));
+			Sprite::Vertex &v = grid.vertices[index];
+			v.x += diff;
+		}
+	}
+}
+
+void scalarSkewY(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	const float invHeight = 1.0f / float(grid.size);
+	for (int column = 0; column < grid.size + 1; column++)
+	{
+		const int x = column;
+		const float distPx = halfWidth + Pivot - x;
+		const float diff = -distPx * Value * invHeight;
+		for (int row = 0; row < grid.size + 1; row++)
+		{
+			const unsigned int index = static_cast<unsigned int>(column + row * (grid.size + 1));
+			Sprite::Vertex &v = grid.vertices[index];
+			v.y += diff;
+		}
+	}
+}
+
+void scalarZoom(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	const int halfHeight = grid.size / 2;
+	const float invWidth = 1.0f / float(grid.size);
+	const float invHeight = 1.0f / float(grid.size);
+	for (int row = 0; row < grid.size + 1; row++)
+	{
+		const int y = row;
+		const float distPy = halfHeight + Pivot - y;
+		const float diffY = -distPy * Value * invHeight;
+		for (int column = 0; column < grid.size + 1; column++)
+		{
+			const int x = column;
+			const float distPx = halfWidth + Pivot - x;
+			const float diffX = -distPx * Value * invWidth;
+			const unsigned int index = static_cast<unsigned int>(column + row * (grid.size + 1));
+			Sprite::Vertex &v = grid.vertices[index];
+			v.x += diffX;
+			v.y += diffY;
+		}
+	}
+}
+
+// The built-in grid functions as they are now, computing the offsets once and applying them with a kernel
+
+void kernelWaveX(BenchmarkGrid &grid)
+{
+	const int halfHeight = grid.size / 2;
+	for (int row = 0; row < grid.size + 1; row++)
+	{
+		const float distPyNorm = (halfHeight + Pivot - row) / halfHeight;
+		grid.rowOffsets[row].set(distPyNorm * Amplitude * sinf(Value * 2.0f * nc::fPi + (Frequency * distPyNorm)), 0.0f);
+	}
+	GridKernels::addOffsets(grid.vertices.data(), grid.size + 1, grid.size + 1, nullptr, grid.rowOffsets.data());
+}
+
+void kernelWaveY(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	for (int column = 0; column < grid.size + 1; column++)
+	{
+		const float distPxNorm = (halfWidth + Pivot - column) / halfWidth;
+		grid.columnOffsets[column].set(0.0f, distPxNorm * Amplitude * sinf(Value * 2.0f * nc::fPi + (Frequency * distPxNorm)));
+	}
+	GridKernels::addOffsets(grid.vertices.data(), grid.size + 1, grid.size + 1, grid.columnOffsets.data(), nullptr);
+}
+
+void kernelSkewX(BenchmarkGrid &grid)
+{
+	const int halfHeight = grid.size / 2;
+	const float invWidth = 1.0f / float(grid.size);
+	for (int row = 0; row < grid.size + 1; row++)
+		grid.rowOffsets[row].set(-(halfHeight + Pivot - row) * Value * invWidth, 0.0f);
+	GridKernels::addOffsets(grid.vertices.data(), grid.size + 1, grid.size + 1, nullptr, grid.rowOffsets.data());
+}
+
+void kernelSkewY(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	const float invHeight = 1.0f / float(grid.size);
+	for (int column = 0; column < grid.size + 1; column++)
+		grid.columnOffsets[column].set(0.0f, -(halfWidth + Pivot - column) * Value * invHeight);
+	GridKernels::addOffsets(grid.vertices.data(), grid.size + 1, grid.size + 1, grid.columnOffsets.data(), nullptr);
+}
+
+void kernelZoom(BenchmarkGrid &grid)
+{
+	const int halfWidth = grid.size / 2;
+	const int halfHeight = grid.size / 2;
+	const float invWidth = 1.0f / float(grid.size);
+	const float invHeight = 1.0f / float(grid.size);
+	for (int row = 0; row < grid.size + 1; row++)
+		grid.rowOffsets[row].set(0.0f, -(halfHeight + Pivot - row) * Value * invHeight);
+	for (int column = 0; column < grid.size + 1; column++)
+		grid.columnOffsets[column].set(-(halfWidth + Pivot - column) * Value * invWidth, 0.0f);
+	GridKernels::addOffsets(grid.vertices.data(), grid.size + 1, grid.size + 1, grid.columnOffsets.data(), grid.rowOffsets.data());
+}
+
+}
+
+namespace Benchmarks {
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void gridKernels()
+{
+	const int gridSizes[] = { 64, 256, 1024 };
+	const int numIterations[] = { 2000, 200, 10 };
+
+	const char *names[] = { "Wave X", "Wave Y", "Skew X", "Skew Y", "Zoom" };
+	void (*scalarFunctions[])(BenchmarkGrid &) = { scalarWaveX, scalarWaveY, scalarSkewX, scalarSkewY, scalarZoom };
+	void (*kernelFunctions[])(BenchmarkGrid &) = { kernelWaveX, kernelWaveY, kernelSkewX, kernelSkewY, kernelZoom };
+
+	LOGI_X("Grid functions benchmark, per-vertex loops against %s kernels", GridKernels::simdName());
+	LOGI_X("%-6s %-8s %12s %12s %8s", "Grid", "Function", "Scalar (us)", "Kernel (us)", "Speedup");
+
+	for (unsigned int i = 0; i < sizeof(gridSizes) / sizeof(*gridSizes); i++)
+	{
+		BenchmarkGrid grid(gridSizes[i]);
+
+		for (unsigned int j = 0; j < sizeof(names) / sizeof(*names); j++)
+		{
+			nc::TimeStamp startTime = nc::TimeStamp::now();
+			for (int k = 0; k < numIterations[i]; k++)
+				scalarFunctions[j](grid);
+			const float scalarTime = startTime.secondsSince() * 1000000.0f / numIterations[i];
+
+			startTime = nc::TimeStamp::now();
+			for (int k = 0; k < numIterations[i]; k++)
+				kernelFunctions[j](grid);
+			const float kernelTime = startTime.secondsSince() * 1000000.0f / numIterations[i];
+
+			LOGI_X("%4d^2 %-8s %12.2f %12.2f %7.2fx", gridSizes[i], names[j], scalarTime, kernelTime, scalarTime / kernelTime);
+		}
+	}
+}
+
+void easingCurves()
+{
+	const char *typeNames[] = { "Linear", "Quadratic", "Cubic", "Quartic", "Quintic", "Sine", "Exponential", "Circular" };
+	// Keyframe curves are never evaluated from a table
+	const unsigned int NumCurveTypes = static_cast<unsigned int>(EasingCurve::Type::CIRC) + 1;
+	static_assert(sizeof(typeNames) / sizeof(*typeNames) == NumCurveTypes, "Missing curve type names");
+	const unsigned int NumEvaluations = 1 << 22;
+
+	LOGI_X("Easing curves benchmark (%u evaluations, %u table intervals)", NumEvaluations, EasingCurve::LookupTableSize);
+	LOGI_X("%-12s %14s %14s %8s %12s", "Curve", "Analytic (ns)", "Table (ns)", "Speedup", "Max error");
+
+	for (unsigned int i = 0; i < NumCurveTypes; i++)
+	{
+		EasingCurve curve(static_cast<EasingCurve::Type>(i), Loop::Mode::DISABLED);
+		// The sum is printed to prevent the compiler from discarding the evaluations
+		float sum = 0.0f;
+
+		nc::TimeStamp startTime = nc::TimeStamp::now();
+		for (unsigned int j = 0; j < NumEvaluations; j++)
+		{
+			curve.time() = (j & 0xFFFF) / 65535.0f;
+			sum += curve.value();
+		}
+		const float analyticTime = startTime.secondsSince() * 1000000000.0f / NumEvaluations;
+
+		curve.enableLookupTable(true);
+		startTime = nc::TimeStamp::now();
+		for (unsigned int j = 0; j < NumEvaluations; j++)
+		{
+			curve.time() = (j & 0xFFFF) / 65535.0f;
+			sum += curve.value();
+		}
+		const float tableTime = startTime.secondsSince() * 1000000000.0f / NumEvaluations;
+
+		LOGI_X("%-12s %14.2f %14.2f %7.2fx %12.2e (%g)", typeNames[i], analyticTime, tableTime,
+		       analyticTime / tableTime, EasingCurve::lookupTableMaxError(curve.type()), sum);
+	}
+}
+
+}
@@ -2,9 +2,12 @@
 
 #include "Canvas.h"
 #include "RenderingResources.h"
+#include "PngSaverPool.h"
 #include <ncine/Application.h>
 #include <ncine/GLTexture.h>
 #include <ncine/GLFramebufferObject.h>
+#include <ncine/GLBufferObject.h>
+#include <nctl/String.h>
 #include <ncine/ImageSaverPng.h>
 
 #include "shader_strings.h"
@@ -13,13 +16,30 @@
 	#undef ERROR
 #endif
 
+#if !defined(NCINE_WITH_OPENGLES) && !defined(__EMSCRIPTEN__)
+	#define WITH_PIXEL_PACK_BUFFERS 1
+#endif
+
+struct Canvas::PixelPackBuffer
+{
+	nctl::UniquePtr<nc::GLBufferObject> pbo;
+	unsigned int capacity = 0;
+	int width = 0;
+	int height = 0;
+#if WITH_PIXEL_PACK_BUFFERS
+	GLsync fence = nullptr;
+#endif
+	nctl::String filename = nctl::String(256);
+};
+
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
 
 Canvas::Canvas()
     : backgroundColor(0.0f, 0.0f, 0.0f, 0.0f),
-      texWidth_(0), texHeight_(0), texSizeInBytes_(0)
+      texWidth_(0), texHeight_(0), texSizeInBytes_(0),
+      firstPendingSave_(0), numPendingSaves_(0)
 {
 	const nc::IGfxCapabilities &gfxCaps = nc::theServiceLocator().gfxCapabilities();
 	maxTextureSize_ = gfxCaps.value(nc::IGfxCapabilities::GLIntValues::MAX_TEXTURE_SIZE);
@@ -27,7 +47,8 @@ Canvas::Canvas()
 
 Canvas::Canvas(int texWidth, int texHeight)
     : backgroundColor(0.0f, 0.0f, 0.0f, 0.0f),
-      texWidth_(texWidth), texHeight_(texHeight), texSizeInBytes_(0)
+      texWidth_(texWidth), texHeight_(texHeight), texSizeInBytes_(0),
+      firstPendingSave_(0), numPendingSaves_(0)
 {
 	const nc::IGfxCapabilities &gfxCaps = nc::theServiceLocator().gfxCapabilities();
 	maxTextureSize_ = gfxCaps.value(nc::IGfxCapabilities::GLIntValues::MAX_TEXTURE_SIZE);
@@ -35,6 +56,12 @@ Canvas::Canvas(int texWidth, int texHeight)
 	resizeTexture(texWidth, texHeight);
 }
 
+Canvas::~Canvas()
+{
+	// Readbacks that have not been completed are discarded
+	discardSaves();
+}
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
@@ -43,6 +70,7 @@ void Canvas::resizeTexture(int width, int height)
 {
 	FATAL_ASSERT(width > 0);
 	FATAL_ASSERT(height > 0);
+	ASSERT(numPendingSaves_ == 0);
 	if (pixels_ == nullptr || width != texWidth_ || height != texHeight_)
 	{
 		texWidth_ = (width <= maxTextureSize_) ? width : maxTextureSize_;
@@ -98,17 +126,24 @@ void Canvas::unbind()
 	glViewport(0, 0, nc::theApplication().widthInt(), nc::theApplication().heightInt());
 }
 
-void Canvas::save(const char *filename)
+void Canvas::readPixels(unsigned char *dest)
 {
+	FATAL_ASSERT(dest != nullptr);
+
 #if !defined(NCINE_WITH_OPENGLES) && !defined(__EMSCRIPTEN__)
 	fbo_->unbind();
-	texture_->getTexImage(0, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.get());
+	texture_->getTexImage(0, GL_RGBA, GL_UNSIGNED_BYTE, dest);
 #else
 	fbo_->bind(GL_READ_FRAMEBUFFER);
 	glReadBuffer(GL_COLOR_ATTACHMENT0);
-	glReadPixels(0, 0, texWidth_, texHeight_, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.get());
+	glReadPixels(0, 0, texWidth_, texHeight_, GL_RGBA, GL_UNSIGNED_BYTE, dest);
 	fbo_->unbind();
 #endif
+}
+
+void Canvas::save(const char *filename)
+{
+	readPixels(pixels_.get());
 
 	nc::ImageSaverPng saver;
 	nc::IImageSaver::Properties props;
@@ -119,7 +154,109 @@ void Canvas::save(const char *filename)
 	saver.saveToFile(props, filename);
 }
 
+void Canvas::save(const char *filename, PngSaverPool &saverPool)
+{
+#if WITH_PIXEL_PACK_BUFFERS
+	if (numPendingSaves_ == NumPixelPackBuffers)
+		endReadback(saverPool);
+	beginReadback(filename);
+#else
+	unsigned char *pixels = saverPool.acquireBuffer(texWidth_, texHeight_);
+	readPixels(pixels);
+	saverPool.submit(filename);
+#endif
+}
+
+void Canvas::finishSaves(PngSaverPool &saverPool)
+{
+	while (numPendingSaves_ > 0)
+		endReadback(saverPool);
+}
+
+void Canvas::discardSaves()
+{
+#if WITH_PIXEL_PACK_BUFFERS
+	for (unsigned int i = 0; i < numPendingSaves_; i++)
+	{
+		PixelPackBuffer &ppb = pixelPackBuffers_[(firstPendingSave_ + i) % NumPixelPackBuffers];
+		glDeleteSync(ppb.fence);
+		ppb.fence = nullptr;
+	}
+	firstPendingSave_ = 0;
+	numPendingSaves_ = 0;
+#endif
+}
+
 void *Canvas::imguiTexId()
 {
 	return reinterpret_cast<void *>(texture_.get());
 }
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void Canvas::beginReadback(const char *filename)
+{
+#if WITH_PIXEL_PACK_BUFFERS
+	FATAL_ASSERT(numPendingSaves_ < NumPixelPackBuffers);
+
+	if (pixelPackBuffers_ == nullptr)
+		pixelPackBuffers_ = nctl::makeUnique<PixelPackBuffer[]>(NumPixelPackBuffers);
+
+	PixelPackBuffer &ppb = pixelPackBuffers_[(firstPendingSave_ + numPendingSaves_) % NumPixelPackBuffers];
+	if (ppb.pbo == nullptr)
+		ppb.pbo = nctl::makeUnique<nc::GLBufferObject>(GL_PIXEL_PACK_BUFFER);
+	if (ppb.capacity < texSizeInBytes_)
+	{
+		ppb.pbo->bufferData(texSizeInBytes_, nullptr, GL_STREAM_READ);
+		ppb.capacity = texSizeInBytes_;
+	}
+	ppb.width = texWidth_;
+	ppb.height = texHeight_;
+	ppb.filename = filename;
+
+	// The read is queued into the buffer object and does not wait for the GPU
+	ppb.pbo->bind();
+	fbo_->bind(GL_READ_FRAMEBUFFER);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(0, 0, texWidth_, texHeight_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	fbo_->unbind();
+	ppb.pbo->unbind();
+	ppb.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	numPendingSaves_++;
+#endif
+}
+
+void Canvas::endReadback(PngSaverPool &saverPool)
+{
+#if WITH_PIXEL_PACK_BUFFERS
+	FATAL_ASSERT(numPendingSaves_ > 0);
+
+	PixelPackBuffer &ppb = pixelPackBuffers_[firstPendingSave_];
+	const GLuint64 timeoutNs = 1000000;
+	GLenum waitResult = glClientWaitSync(ppb.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+	while (waitResult == GL_TIMEOUT_EXPIRED)
+		waitResult = glClientWaitSync(ppb.fence, 0, timeoutNs);
+	glDeleteSync(ppb.fence);
+	ppb.fence = nullptr;
+
+	const unsigned int sizeInBytes = static_cast<unsigned int>(ppb.width * ppb.height * 4);
+	unsigned char *pixels = saverPool.acquireBuffer(ppb.width, ppb.height);
+	ppb.pbo->bind();
+	const void *mappedPixels = ppb.pbo->mapBufferRange(0, sizeInBytes, GL_MAP_READ_BIT);
+	if (mappedPixels != nullptr)
+	{
+		memcpy(pixels, mappedPixels, sizeInBytes);
+		ppb.pbo->unmap();
+		saverPool.submit(ppb.filename.data());
+	}
+	else
+		LOGE_X("Cannot map the pixel pack buffer for \"%s\"", ppb.filename.data());
+	ppb.pbo->unbind();
+
+	firstPendingSave_ = (firstPendingSave_ + 1) % NumPixelPackBuffers;
+	numPendingSaves_--;
+#endif
+}
@@ -39,6 +39,11 @@ void CurveAnimation::play()
 }
 
 void CurveAnimation::update(float deltaTime)
+{
+	updateCurve(deltaTime, insideSequential());
+}
+
+void CurveAnimation::updateCurve(float deltaTime, bool isInsideSequential)
 {
 	switch (state_)
 	{
@@ -57,7 +62,7 @@ void CurveAnimation::update(float deltaTime)
 			if (shouldWaitDelay(deltaTime))
 				return;
 
-			if (insideSequential() && curve_.loop().mode() != Loop::Mode::DISABLED)
+			if (isInsideSequential && curve_.loop().mode() != Loop::Mode::DISABLED)
 			{
 				// Disable looping if the animation is inside a sequential group
 				const Loop::Mode loopMode = curve_.loop().mode();
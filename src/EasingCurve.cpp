@@ -2,13 +2,48 @@
 #include <ncine/common_constants.h>
 #include "EasingCurve.h"
 
+namespace {
+
+const unsigned int NumCurveTypes = static_cast<unsigned int>(EasingCurve::Type::CIRC) + 1;
+
+}
+
+/// The curve values sampled at regular intervals in the unit interval, for every curve type
+struct EasingCurve::LookupTables
+{
+	float values[NumCurveTypes][LookupTableSize + 1];
+	float maxErrors[NumCurveTypes];
+
+	LookupTables()
+	{
+		// Number of points between two samples where the interpolation error is measured
+		const unsigned int NumErrorPoints = 16;
+
+		for (unsigned int i = 0; i < NumCurveTypes; i++)
+		{
+			const Type type = static_cast<Type>(i);
+			for (unsigned int j = 0; j <= LookupTableSize; j++)
+				values[i][j] = analyticValue(type, j / static_cast<float>(LookupTableSize));
+
+			maxErrors[i] = 0.0f;
+			for (unsigned int j = 0; j < LookupTableSize * NumErrorPoints; j++)
+			{
+				const float time = j / static_cast<float>(LookupTableSize * NumErrorPoints);
+				const float error = fabsf(lookupTableValue(values[i], time) - analyticValue(type, time));
+				if (error > maxErrors[i])
+					maxErrors[i] = error;
+			}
+		}
+	}
+};
+
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
 
 EasingCurve::EasingCurve(Type type, Loop::Mode loopMode)
-    : type_(type), loop_(loopMode), withInitialValue_(false), time_(0.0f),
-      initialValue_(0.0f), start_(0.0f), end_(1.0f), scale_(1.0f), shift_(0.0f)
+    : type_(type), loop_(loopMode), withInitialValue_(false), withLookupTable_(false), time_(0.0f),
+      initialValue_(0.0f), start_(0.0f), end_(1.0f), scale_(1.0f), shift_(0.0f), keyframes_(4), keyframeCursor_(0)
 {
 }
 
@@ -24,6 +59,8 @@ void EasingCurve::setTime(float time)
 		time_ = start_;
 	else if (time_ > end_)
 		time_ = end_;
+
+	updateKeyframeCursor();
 }
 
 void EasingCurve::setInitialValue(float initialValue)
@@ -53,31 +90,20 @@ void EasingCurve::reset()
 	}
 	else
 		time_ = initialValue_;
+
+	updateKeyframeCursor();
 }
 
 float EasingCurve::value()
 {
-	switch (type_)
-	{
-		case Type::LINEAR:
-			return time_ * scale_ + shift_;
-		case Type::QUAD:
-			return time_ * time_ * scale_ + shift_;
-		case Type::CUBIC:
-			return time_ * time_ * time_ * scale_ + shift_;
-		case Type::QUART:
-			return time_ * time_ * time_ * time_ * scale_ + shift_;
-		case Type::QUINT:
-			return time_ * time_ * time_ * time_ * time_ * scale_ + shift_;
-		case Type::SINE:
-			return sinf(time_ * ncine::fPi) * scale_ + shift_;
-		case Type::EXPO:
-			return (1.0f - powf(2, time_)) * scale_ + shift_;
-		case Type::CIRC:
-			return sqrtf(1.0f - time_ * time_) * scale_ + shift_;
-	}
+	if (type_ == Type::KEYFRAMES)
+		return keyframeValue(time_) * scale_ + shift_;
 
-	return 1.0f;
+	// The tables only cover the unit interval
+	if (withLookupTable_ && time_ >= 0.0f && time_ <= 1.0f)
+		return lookupTableValue(type_, time_) * scale_ + shift_;
+
+	return analyticValue(type_, time_) * scale_ + shift_;
 }
 
 void EasingCurve::next(float deltaTime)
@@ -138,4 +164,176 @@ void EasingCurve::next(float deltaTime)
 			loop_.goForward(true);
 		}
 	}
+
+	updateKeyframeCursor();
+}
+
+unsigned int EasingCurve::addKeyframe(const Keyframe &keyframe)
+{
+	// Keyframes with the same time are kept in insertion order
+	unsigned int index = 0;
+	while (index < keyframes_.size() && keyframes_[index].time <= keyframe.time)
+		index++;
+
+	keyframes_.insertAt(index, keyframe);
+	keyframeCursor_ = 0;
+	updateKeyframeCursor();
+
+	return index;
+}
+
+void EasingCurve::removeKeyframe(unsigned int index)
+{
+	keyframes_.removeAt(index);
+	keyframeCursor_ = 0;
+	updateKeyframeCursor();
+}
+
+unsigned int EasingCurve::setKeyframe(unsigned int index, const Keyframe &keyframe)
+{
+	if (keyframe.time == keyframes_[index].time)
+	{
+		keyframes_[index] = keyframe;
+		return index;
+	}
+
+	removeKeyframe(index);
+	return addKeyframe(keyframe);
+}
+
+float EasingCurve::lookupTableMaxError(Type type)
+{
+	// Keyframe curves are never evaluated from a table
+	if (type == Type::KEYFRAMES)
+		return 0.0f;
+	return lookupTables().maxErrors[static_cast<unsigned int>(type)];
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+float EasingCurve::analyticValue(Type type, float time)
+{
+	switch (type)
+	{
+		case Type::LINEAR:
+			return time;
+		case Type::QUAD:
+			return time * time;
+		case Type::CUBIC:
+			return time * time * time;
+		case Type::QUART:
+			return time * time * time * time;
+		case Type::QUINT:
+			return time * time * time * time * time;
+		case Type::SINE:
+			return sinf(time * ncine::fPi);
+		case Type::EXPO:
+			return 1.0f - powf(2, time);
+		case Type::CIRC:
+			return sqrtf(1.0f - time * time);
+		case Type::KEYFRAMES:
+			// Evaluated by `keyframeValue()`, as it depends on the curve keyframes
+			break;
+	}
+
+	return 1.0f;
+}
+
+const EasingCurve::LookupTables &EasingCurve::lookupTables()
+{
+	// Built the first time a table is needed
+	static const LookupTables tables;
+	return tables;
+}
+
+float EasingCurve::lookupTableValue(Type type, float time)
+{
+	return lookupTableValue(lookupTables().values[static_cast<unsigned int>(type)], time);
+}
+
+float EasingCurve::lookupTableValue(const float *values, float time)
+{
+	const float position = time * LookupTableSize;
+	unsigned int index = static_cast<unsigned int>(position);
+	// The last sample is only reached exactly at the end of the interval
+	if (index >= LookupTableSize)
+		index = LookupTableSize - 1;
+	const float fraction = position - index;
+
+	return values[index] + (values[index + 1] - values[index]) * fraction;
+}
+
+unsigned int EasingCurve::findKeyframeSegment(float time) const
+{
+	// The time is expected to be between the first and the last keyframe
+	const unsigned int numKeyframes = keyframes_.size();
+	ASSERT(numKeyframes > 1);
+
+	// The time moves by small steps, the segment of the cursor or one of its neighbours usually contains it
+	const unsigned int cursor = keyframeCursor_;
+	if (cursor + 1 < numKeyframes)
+	{
+		if (time >= keyframes_[cursor].time)
+		{
+			if (time < keyframes_[cursor + 1].time)
+				return cursor;
+			else if (cursor + 2 < numKeyframes && time < keyframes_[cursor + 2].time)
+				return cursor + 1;
+		}
+		else if (cursor > 0 && time >= keyframes_[cursor - 1].time)
+			return cursor - 1;
+	}
+
+	unsigned int first = 0;
+	unsigned int last = numKeyframes - 1;
+	while (last - first > 1)
+	{
+		const unsigned int middle = (first + last) / 2;
+		if (keyframes_[middle].time <= time)
+			first = middle;
+		else
+			last = middle;
+	}
+
+	return first;
+}
+
+void EasingCurve::updateKeyframeCursor()
+{
+	const unsigned int numKeyframes = keyframes_.size();
+	if (type_ == Type::KEYFRAMES && numKeyframes > 1 &&
+	    time_ > keyframes_[0].time && time_ < keyframes_[numKeyframes - 1].time)
+	{
+		keyframeCursor_ = findKeyframeSegment(time_);
+	}
+}
+
+float EasingCurve::keyframeValue(float time) const
+{
+	const unsigned int numKeyframes = keyframes_.size();
+	if (numKeyframes == 0)
+		return 0.0f;
+	else if (time <= keyframes_[0].time)
+		return keyframes_[0].value;
+	else if (time >= keyframes_[numKeyframes - 1].time)
+		return keyframes_[numKeyframes - 1].value;
+
+	const unsigned int index = findKeyframeSegment(time);
+	const Keyframe &first = keyframes_[index];
+	const Keyframe &second = keyframes_[index + 1];
+
+	// Tangents are slopes in curve time, they are scaled to the normalized segment
+	const float length = second.time - first.time;
+	const float t = (time - first.time) / length;
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+
+	const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+	const float h10 = t3 - 2.0f * t2 + t;
+	const float h01 = -2.0f * t3 + 3.0f * t2;
+	const float h11 = t3 - t2;
+
+	return h00 * first.value + h10 * length * first.outTangent + h01 * second.value + h11 * length * second.inTangent;
 }
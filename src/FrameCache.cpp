@@ -0,0 +1,141 @@
+#include "FrameCache.h"
+#include "Canvas.h"
+#include <ncine/GLTexture.h>
+#include <ncine/GLFramebufferObject.h>
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+FrameCache::FrameCache(unsigned int maxBytes)
+    : maxBytes_(maxBytes), width_(0), height_(0), numFrames_(0),
+      revision_(0), useCounter_(0), entries_(16)
+{
+}
+
+FrameCache::~FrameCache() = default;
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+unsigned int FrameCache::capacity(const Canvas &canvas) const
+{
+	if (canvas.texSizeInBytes() == 0)
+		return 0;
+	return maxBytes_ / canvas.texSizeInBytes();
+}
+
+bool FrameCache::restore(int frame, unsigned int revision, Canvas &canvas)
+{
+	if (revision != revision_ || width_ != canvas.texWidth() || height_ != canvas.texHeight())
+		return false;
+
+	const int index = findFrame(frame);
+	if (index < 0)
+		return false;
+
+	Entry &entry = entries_[index];
+	entry.lastUse = ++useCounter_;
+
+	entry.fbo->bind(GL_READ_FRAMEBUFFER);
+	canvas.bindDraw();
+	glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	canvas.unbind();
+
+	return true;
+}
+
+void FrameCache::store(int frame, unsigned int revision, Canvas &canvas)
+{
+	if (width_ != canvas.texWidth() || height_ != canvas.texHeight())
+	{
+		// The textures of a different size cannot be reused
+		entries_.clear();
+		numFrames_ = 0;
+		width_ = canvas.texWidth();
+		height_ = canvas.texHeight();
+	}
+	if (revision != revision_)
+	{
+		clear();
+		revision_ = revision;
+	}
+
+	int index = findFrame(frame);
+	if (index < 0)
+	{
+		// Prefer an empty entry, then a new one if the memory budget allows it, then the least recently used one
+		int leastRecentlyUsed = -1;
+		for (unsigned int i = 0; i < entries_.size(); i++)
+		{
+			if (entries_[i].frame < 0)
+			{
+				index = i;
+				break;
+			}
+			else if (leastRecentlyUsed < 0 || entries_[i].lastUse < entries_[leastRecentlyUsed].lastUse)
+				leastRecentlyUsed = i;
+		}
+
+		if (index < 0)
+		{
+			if (entries_.size() < capacity(canvas))
+			{
+				entries_.pushBack(Entry());
+				index = entries_.size() - 1;
+			}
+			else if (leastRecentlyUsed >= 0)
+			{
+				index = leastRecentlyUsed;
+				numFrames_--;
+			}
+			else
+				return;
+		}
+
+		Entry &entry = entries_[index];
+		if (entry.texture == nullptr)
+		{
+			entry.texture = nctl::makeUnique<nc::GLTexture>(GL_TEXTURE_2D);
+			entry.texture->texStorage2D(1, GL_RGBA8, width_, height_);
+			entry.texture->texParameteri(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			entry.texture->texParameteri(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+			entry.fbo = nctl::makeUnique<nc::GLFramebufferObject>();
+			entry.fbo->attachTexture(*entry.texture, GL_COLOR_ATTACHMENT0);
+		}
+		entry.frame = frame;
+		numFrames_++;
+	}
+
+	Entry &entry = entries_[index];
+	entry.lastUse = ++useCounter_;
+
+	canvas.bindRead();
+	entry.fbo->bind(GL_DRAW_FRAMEBUFFER);
+	glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	canvas.unbind();
+}
+
+void FrameCache::clear()
+{
+	for (unsigned int i = 0; i < entries_.size(); i++)
+		entries_[i].frame = -1;
+	numFrames_ = 0;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+int FrameCache::findFrame(int frame) const
+{
+	for (unsigned int i = 0; i < entries_.size(); i++)
+	{
+		if (entries_[i].frame == frame)
+			return static_cast<int>(i);
+	}
+
+	return -1;
+}
@@ -12,7 +12,8 @@ GridAnimation::GridAnimation()
 }
 
 GridAnimation::GridAnimation(Sprite *sprite)
-    : SpriteAnimation(nullptr), gridFunction_(nullptr), params_(4)
+    : SpriteAnimation(nullptr), gridFunction_(nullptr), params_(4),
+      hasLastInputs_(false), lastValue_(0.0f), lastParams_(4)
 {
 	setSprite(sprite);
 }
@@ -35,7 +36,25 @@ nctl::UniquePtr<IAnimation> GridAnimation::clone() const
 void GridAnimation::perform()
 {
 	if (sprite_ && sprite_->visible && gridFunction_)
-		gridFunction_->execute(*this);
+	{
+		// Built-in functions are evaluated by the grid vertex shader when possible
+		if (gridFunction_->shaderId() >= 0 && sprite_->usesShaderGrid())
+		{
+			float params[Sprite::GridFunctionShaderParams] = {};
+			for (unsigned int i = 0; i < params_.size() && i < Sprite::GridFunctionShaderParams; i++)
+				params[i] = params_[i].value0;
+			if (sprite_->addShaderGridFunction(gridFunction_->shaderId(), curve_.value(), params))
+				return;
+		}
+
+		if (sprite_->defersGridAnimations())
+			sprite_->queueGridAnimation(this, updateLastInputs());
+		else
+		{
+			gridFunction_->execute(*this);
+			sprite_->markVerticesModified();
+		}
+	}
 }
 
 void GridAnimation::setSprite(Sprite *sprite)
@@ -43,11 +62,15 @@ void GridAnimation::setSprite(Sprite *sprite)
 	if (sprite_ != sprite)
 	{
 		if (sprite_)
+		{
+			sprite_->dequeueGridAnimation(this);
 			sprite_->decrementGridAnimCounter();
+		}
 		if (sprite)
 			sprite->incrementGridAnimCounter();
 
 		sprite_ = sprite;
+		hasLastInputs_ = false;
 	}
 }
 
@@ -69,4 +92,25 @@ void GridAnimation::setFunction(const GridFunction *function)
 		params_.clear();
 
 	gridFunction_ = function;
+	hasLastInputs_ = false;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+bool GridAnimation::updateLastInputs()
+{
+	bool changed = (hasLastInputs_ == false || lastValue_ != curve_.value() || lastParams_.size() != params_.size());
+	for (unsigned int i = 0; i < params_.size() && changed == false; i++)
+		changed = (lastParams_[i].value0 != params_[i].value0 || lastParams_[i].value1 != params_[i].value1);
+
+	if (changed)
+	{
+		hasLastInputs_ = true;
+		lastValue_ = curve_.value();
+		lastParams_ = params_;
+	}
+
+	return changed;
 }
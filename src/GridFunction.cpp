@@ -1,11 +1,13 @@
 #include "GridFunction.h"
+#include "GridAnimation.h"
+#include "Sprite.h"
 
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
 
 GridFunction::GridFunction()
-    : name_(MaxNameLength), parametersInfo_(4), callback_(nullptr)
+    : name_(MaxNameLength), parametersInfo_(4), callback_(nullptr), shaderId_(-1)
 {
 }
 
@@ -51,6 +53,13 @@ GridFunction::ParameterInfo &GridFunction::addParameter(const char *name, Parame
 
 void GridFunction::execute(GridAnimation &animation) const
 {
+	if (callback_ != nullptr && animation.sprite() != nullptr)
+		callback_(animation, 0, animation.sprite()->gridHeight() + 1);
+}
+
+void GridFunction::execute(GridAnimation &animation, int firstRow, int lastRow) const
+{
+	ASSERT(firstRow >= 0 && firstRow <= lastRow);
 	if (callback_ != nullptr)
-		callback_(animation);
+		callback_(animation, firstRow, lastRow);
 }
@@ -1,6 +1,7 @@
 #include "GridFunctionLibrary.h"
 #include "GridAnimation.h"
 #include "Sprite.h"
+#include "GridKernels.h"
 
 nctl::Array<GridFunction> GridFunctionLibrary::gridFunctions_(4);
 
@@ -10,7 +11,13 @@ nctl::Array<GridFunction> GridFunctionLibrary::gridFunctions_(4);
 
 namespace {
 
-void waveX(GridAnimation &gridAnimation)
+// Grid functions can run on different threads at the same time, each one with its own offsets
+/// Per-row offsets computed by a grid function before applying them with a kernel
+thread_local nctl::Array<nc::Vector2f> rowOffsets(64);
+/// Per-column offsets computed by a grid function before applying them with a kernel
+thread_local nctl::Array<nc::Vector2f> columnOffsets(64);
+
+void waveX(GridAnimation &gridAnimation, int firstRow, int lastRow)
 {
 	const float value = gridAnimation.curve().value();
 	const nctl::Array<GridFunctionParameter> &parameters = gridAnimation.parameters();
@@ -20,25 +27,20 @@ void waveX(GridAnimation &gridAnimation)
 	const float py = parameters[2].value0;
 	Sprite *sprite = gridAnimation.sprite();
 
-	const int width = sprite->width();
-	const int height = sprite->height();
-	const int halfHeight = height / 2;
-	nctl::Array<Sprite::Vertex> &interleavedVertices = sprite->interleavedVertices();
+	const int gridWidth = sprite->gridWidth();
+	const int halfHeight = sprite->height() / 2;
 
-	for (int y = 0; y < height + 1; y++)
+	rowOffsets.setSize(lastRow - firstRow);
+	for (int row = firstRow; row < lastRow; row++)
 	{
+		const int y = sprite->gridTexelY(row);
 		const float distPyNorm = (halfHeight + py - y) / halfHeight;
-		const float diff = distPyNorm * amplitude * sinf(value * 2.0f * nc::fPi + (frequency * distPyNorm));
-		for (int x = 0; x < width + 1; x++)
-		{
-			const unsigned int index = static_cast<unsigned int>(x + y * (width + 1));
-			Sprite::Vertex &v = interleavedVertices[index];
-			v.x += diff;
-		}
+		rowOffsets[row - firstRow].set(distPyNorm * amplitude * sinf(value * 2.0f * nc::fPi + (frequency * distPyNorm)), 0.0f);
 	}
+	GridKernels::addOffsets(sprite->vertices().data() + firstRow * (gridWidth + 1), gridWidth + 1, lastRow - firstRow, nullptr, rowOffsets.data());
 }
 
-void waveY(GridAnimation &gridAnimation)
+void waveY(GridAnimation &gridAnimation, int firstRow, int lastRow)
 {
 	const float value = gridAnimation.curve().value();
 	const nctl::Array<GridFunctionParameter> &parameters = gridAnimation.parameters();
@@ -48,25 +50,20 @@ void waveY(GridAnimation &gridAnimation)
 	const float px = parameters[2].value0;
 	Sprite *sprite = gridAnimation.sprite();
 
-	const int width = sprite->width();
-	const int height = sprite->height();
-	const int halfWidth = width / 2;
-	nctl::Array<Sprite::Vertex> &interleavedVertices = sprite->interleavedVertices();
+	const int gridWidth = sprite->gridWidth();
+	const int halfWidth = sprite->width() / 2;
 
-	for (int x = 0; x < width + 1; x++)
+	columnOffsets.setSize(gridWidth + 1);
+	for (int column = 0; column < gridWidth + 1; column++)
 	{
+		const int x = sprite->gridTexelX(column);
 		const float distPxNorm = (halfWidth + px - x) / halfWidth;
-		const float diff = distPxNorm * amplitude * sinf(value * 2.0f * nc::fPi + (frequency * distPxNorm));
-		for (int y = 0; y < height + 1; y++)
-		{
-			const unsigned int index = static_cast<unsigned int>(x + y * (width + 1));
-			Sprite::Vertex &v = interleavedVertices[index];
-			v.y += diff;
-		}
+		columnOffsets[column].set(0.0f, distPxNorm * amplitude * sinf(value * 2.0f * nc::fPi + (frequency * distPxNorm)));
 	}
+	GridKernels::addOffsets(sprite->vertices().data() + firstRow * (gridWidth + 1), gridWidth + 1, lastRow - firstRow, columnOffsets.data(), nullptr);
 }
 
-void skewX(GridAnimation &gridAnimation)
+void skewX(GridAnimation &gridAnimation, int firstRow, int lastRow)
 {
 	const float value = gridAnimation.curve().value();
 	const nctl::Array<GridFunctionParameter> &parameters = gridAnimation.parameters();
@@ -74,26 +71,21 @@ void skewX(GridAnimation &gridAnimation)
 	const float py = parameters[0].value0;
 	Sprite *sprite = gridAnimation.sprite();
 
-	const int width = sprite->width();
-	const int height = sprite->height();
-	const int halfHeight = height / 2;
-	const float invWidth = 1.0f / float(width);
-	nctl::Array<Sprite::Vertex> &interleavedVertices = sprite->interleavedVertices();
+	const int gridWidth = sprite->gridWidth();
+	const int halfHeight = sprite->height() / 2;
+	const float invWidth = 1.0f / float(sprite->width());
 
-	for (int y = 0; y < height + 1; y++)
+	rowOffsets.setSize(lastRow - firstRow);
+	for (int row = firstRow; row < lastRow; row++)
 	{
+		const int y = sprite->gridTexelY(row);
 		const float distPy = halfHeight + py - y;
-		const float diff = -distPy * value * invWidth;
-		for (int x = 0; x < width + 1; x++)
-		{
-			const unsigned int index = static_cast<unsigned int>(x + y * (width + 1));
-			Sprite::Vertex &v = interleavedVertices[index];
-			v.x += diff;
-		}
+		rowOffsets[row - firstRow].set(-distPy * value * invWidth, 0.0f);
 	}
+	GridKernels::addOffsets(sprite->vertices().data() + firstRow * (gridWidth + 1), gridWidth + 1, lastRow - firstRow, nullptr, rowOffsets.data());
 }
 
-void skewY(GridAnimation &gridAnimation)
+void skewY(GridAnimation &gridAnimation, int firstRow, int lastRow)
 {
 	const float value = gridAnimation.curve().value();
 	const nctl::Array<GridFunctionParameter> &parameters = gridAnimation.parameters();
@@ -101,26 +93,21 @@ void skewY(GridAnimation &gridAnimation)
 	const float px = parameters[0].value0;
 	Sprite *sprite = gridAnimation.sprite();
 
-	const int width = sprite->width();
-	const int height = sprite->height();
-	const int halfWidth = width / 2;
-	const float invHeight = 1.0f / float(height);
-	nctl::Array<Sprite::Vertex> &interleavedVertices = sprite->interleavedVertices();
+	const int gridWidth = sprite->gridWidth();
+	const int halfWidth = sprite->width() / 2;
+	const float invHeight = 1.0f / float(sprite->height());
 
-	for (int x = 0; x < width + 1; x++)
+	columnOffsets.setSize(gridWidth + 1);
+	for (int column = 0; column < gridWidth + 1; column++)
 	{
+		const int x = sprite->gridTexelX(column);
 		const float distPx = halfWidth + px - x;
-		const float diff = -distPx * value * invHeight;
-		for (int y = 0; y < height + 1; y++)
-		{
-			const unsigned int index = static_cast<unsigned int>(x + y * (width + 1));
-			Sprite::Vertex &v = interleavedVertices[index];
-			v.y += diff;
-		}
+		columnOffsets[column].set(0.0f, -distPx * value * invHeight);
 	}
+	GridKernels::addOffsets(sprite->vertices().data() + firstRow * (gridWidth + 1), gridWidth + 1, lastRow - firstRow, columnOffsets.data(), nullptr);
 }
 
-void zoom(GridAnimation &gridAnimation)
+void zoom(GridAnimation &gridAnimation, int firstRow, int lastRow)
 {
 	const float value = gridAnimation.curve().value();
 	const nctl::Array<GridFunctionParameter> &parameters = gridAnimation.parameters();
@@ -129,28 +116,27 @@ void zoom(GridAnimation &gridAnimation)
 	const float py = parameters[1].value0;
 	Sprite *sprite = gridAnimation.sprite();
 
-	const int width = sprite->width();
-	const int height = sprite->height();
-	const int halfWidth = width / 2;
-	const int halfHeight = height / 2;
-	const float invWidth = 1.0f / float(width);
-	const float invHeight = 1.0f / float(height);
-	nctl::Array<Sprite::Vertex> &interleavedVertices = sprite->interleavedVertices();
+	const int gridWidth = sprite->gridWidth();
+	const int halfWidth = sprite->width() / 2;
+	const int halfHeight = sprite->height() / 2;
+	const float invWidth = 1.0f / float(sprite->width());
+	const float invHeight = 1.0f / float(sprite->height());
 
-	for (int y = 0; y < height + 1; y++)
+	rowOffsets.setSize(lastRow - firstRow);
+	for (int row = firstRow; row < lastRow; row++)
 	{
+		const int y = sprite->gridTexelY(row);
 		const float distPy = halfHeight + py - y;
-		const float diffY = -distPy * value * invHeight;
-		for (int x = 0; x < width + 1; x++)
-		{
-			const float distPx = halfWidth + px - x;
-			const float diffX = -distPx * value * invWidth;
-			const unsigned int index = static_cast<unsigned int>(x + y * (width + 1));
-			Sprite::Vertex &v = interleavedVertices[index];
-			v.x += diffX;
-			v.y += diffY;
-		}
+		rowOffsets[row - firstRow].set(0.0f, -distPy * value * invHeight);
+	}
+	columnOffsets.setSize(gridWidth + 1);
+	for (int column = 0; column < gridWidth + 1; column++)
+	{
+		const int x = sprite->gridTexelX(column);
+		const float distPx = halfWidth + px - x;
+		columnOffsets[column].set(-distPx * value * invWidth, 0.0f);
 	}
+	GridKernels::addOffsets(sprite->vertices().data() + firstRow * (gridWidth + 1), gridWidth + 1, lastRow - firstRow, columnOffsets.data(), rowOffsets.data());
 }
 
 }
@@ -173,6 +159,7 @@ void GridFunctionLibrary::init()
 		anchor.maxMultiply = GridFunction::ValueMultiply::SPRITE_HEIGHT;
 		anchor.anchorType = GridFunction::AnchorType::Y;
 		waveXFunction.setCallback(waveX);
+		waveXFunction.setShaderId(0);
 		gridFunctions_.pushBack(waveXFunction);
 	}
 
@@ -192,6 +179,7 @@ void GridFunctionLibrary::init()
 		anchor.maxMultiply = GridFunction::ValueMultiply::SPRITE_WIDTH;
 		anchor.anchorType = GridFunction::AnchorType::X;
 		waveYFunction.setCallback(waveY);
+		waveYFunction.setShaderId(1);
 		gridFunctions_.pushBack(waveYFunction);
 	}
 
@@ -205,6 +193,7 @@ void GridFunctionLibrary::init()
 		anchor.maxMultiply = GridFunction::ValueMultiply::SPRITE_HEIGHT;
 		anchor.anchorType = GridFunction::AnchorType::Y;
 		skewXFunction.setCallback(skewX);
+		skewXFunction.setShaderId(2);
 		gridFunctions_.pushBack(skewXFunction);
 	}
 
@@ -218,6 +207,7 @@ void GridFunctionLibrary::init()
 		anchor.maxMultiply = GridFunction::ValueMultiply::SPRITE_WIDTH;
 		anchor.anchorType = GridFunction::AnchorType::X;
 		skewYFunction.setCallback(skewY);
+		skewYFunction.setShaderId(3);
 		gridFunctions_.pushBack(skewYFunction);
 	}
 
@@ -237,6 +227,7 @@ void GridFunctionLibrary::init()
 		anchory.maxMultiply = GridFunction::ValueMultiply::SPRITE_WIDTH;
 		anchory.anchorType = GridFunction::AnchorType::Y;
 		zoomFunction.setCallback(zoom);
+		zoomFunction.setShaderId(4);
 		gridFunctions_.pushBack(zoomFunction);
 	}
 }
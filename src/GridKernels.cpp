@@ -0,0 +1,153 @@
+#include "GridKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define WITH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define WITH_NEON 1
+#endif
+
+namespace {
+
+/// Number of vertices processed per inner loop iteration
+const int RowBlockSize = 4;
+
+}
+
+namespace GridKernels {
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void addOffsetsScalar(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets)
+{
+	for (int y = 0; y < numRows; y++)
+	{
+		const float rowX = rowOffsets ? rowOffsets[y].x : 0.0f;
+		const float rowY = rowOffsets ? rowOffsets[y].y : 0.0f;
+		Sprite::Vertex *row = vertices + y * verticesPerRow;
+		for (int x = 0; x < verticesPerRow; x++)
+		{
+			row[x].x += rowX + (columnOffsets ? columnOffsets[x].x : 0.0f);
+			row[x].y += rowY + (columnOffsets ? columnOffsets[x].y : 0.0f);
+		}
+	}
+}
+
+#if WITH_SSE2
+void addOffsets(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets)
+{
+	static_assert(sizeof(Sprite::Vertex) == 2 * sizeof(float), "Two vertices should fit in a SIMD register");
+
+	const int blockedVertices = verticesPerRow - (verticesPerRow % RowBlockSize);
+	float *data = &vertices[0].x;
+	const float *columnData = columnOffsets ? &columnOffsets[0].x : nullptr;
+
+	for (int y = 0; y < numRows; y++)
+	{
+		// Every register holds the positions of two consecutive vertices
+		const float rowX = rowOffsets ? rowOffsets[y].x : 0.0f;
+		const float rowY = rowOffsets ? rowOffsets[y].y : 0.0f;
+		const __m128 rowOffset = _mm_setr_ps(rowX, rowY, rowX, rowY);
+		float *row = data + y * verticesPerRow * 2;
+
+		int x = 0;
+		if (columnData == nullptr)
+		{
+			for (; x < blockedVertices; x += RowBlockSize)
+			{
+				_mm_storeu_ps(row + x * 2 + 0, _mm_add_ps(_mm_loadu_ps(row + x * 2 + 0), rowOffset));
+				_mm_storeu_ps(row + x * 2 + 4, _mm_add_ps(_mm_loadu_ps(row + x * 2 + 4), rowOffset));
+			}
+		}
+		else
+		{
+			// Column offsets have the same layout as vertices and can be loaded directly
+			for (; x < blockedVertices; x += RowBlockSize)
+			{
+				const __m128 offset0 = _mm_add_ps(_mm_loadu_ps(columnData + x * 2 + 0), rowOffset);
+				const __m128 offset1 = _mm_add_ps(_mm_loadu_ps(columnData + x * 2 + 4), rowOffset);
+				_mm_storeu_ps(row + x * 2 + 0, _mm_add_ps(_mm_loadu_ps(row + x * 2 + 0), offset0));
+				_mm_storeu_ps(row + x * 2 + 4, _mm_add_ps(_mm_loadu_ps(row + x * 2 + 4), offset1));
+			}
+		}
+
+		for (; x < verticesPerRow; x++)
+		{
+			row[x * 2 + 0] += rowX + (columnData ? columnData[x * 2 + 0] : 0.0f);
+			row[x * 2 + 1] += rowY + (columnData ? columnData[x * 2 + 1] : 0.0f);
+		}
+	}
+}
+
+const char *simdName()
+{
+	return "SSE2";
+}
+#elif WITH_NEON
+void addOffsets(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets)
+{
+	static_assert(sizeof(Sprite::Vertex) == 2 * sizeof(float), "Two vertices should fit in a SIMD register");
+
+	const int blockedVertices = verticesPerRow - (verticesPerRow % RowBlockSize);
+	float *data = &vertices[0].x;
+	const float *columnData = columnOffsets ? &columnOffsets[0].x : nullptr;
+
+	for (int y = 0; y < numRows; y++)
+	{
+		// Every register holds the positions of two consecutive vertices
+		const float rowX = rowOffsets ? rowOffsets[y].x : 0.0f;
+		const float rowY = rowOffsets ? rowOffsets[y].y : 0.0f;
+		const float rowValues[2] = { rowX, rowY };
+		const float32x2_t rowPair = vld1_f32(rowValues);
+		const float32x4_t rowOffset = vcombine_f32(rowPair, rowPair);
+		float *row = data + y * verticesPerRow * 2;
+
+		int x = 0;
+		if (columnData == nullptr)
+		{
+			for (; x < blockedVertices; x += RowBlockSize)
+			{
+				vst1q_f32(row + x * 2 + 0, vaddq_f32(vld1q_f32(row + x * 2 + 0), rowOffset));
+				vst1q_f32(row + x * 2 + 4, vaddq_f32(vld1q_f32(row + x * 2 + 4), rowOffset));
+			}
+		}
+		else
+		{
+			// Column offsets have the same layout as vertices and can be loaded directly
+			for (; x < blockedVertices; x += RowBlockSize)
+			{
+				const float32x4_t offset0 = vaddq_f32(vld1q_f32(columnData + x * 2 + 0), rowOffset);
+				const float32x4_t offset1 = vaddq_f32(vld1q_f32(columnData + x * 2 + 4), rowOffset);
+				vst1q_f32(row + x * 2 + 0, vaddq_f32(vld1q_f32(row + x * 2 + 0), offset0));
+				vst1q_f32(row + x * 2 + 4, vaddq_f32(vld1q_f32(row + x * 2 + 4), offset1));
+			}
+		}
+
+		for (; x < verticesPerRow; x++)
+		{
+			row[x * 2 + 0] += rowX + (columnData ? columnData[x * 2 + 0] : 0.0f);
+			row[x * 2 + 1] += rowY + (columnData ? columnData[x * 2 + 1] : 0.0f);
+		}
+	}
+}
+
+const char *simdName()
+{
+	return "NEON";
+}
+#else
+void addOffsets(Sprite::Vertex *vertices, int verticesPerRow, int numRows, const nc::Vector2f *columnOffsets, const nc::Vector2f *rowOffsets)
+{
+	addOffsetsScalar(vertices, verticesPerRow, numRows, columnOffsets, rowOffsets);
+}
+
+const char *simdName()
+{
+	return "Scalar";
+}
+#endif
+
+}
@@ -15,7 +15,7 @@
 
 namespace {
 
-const int ProjectVersion = 7;
+const int ProjectVersion = 10;
 
 }
 
@@ -146,7 +146,8 @@ Array::Array(LuaSerializer &ls, const char *name)
 Array::~Array()
 {
 	lua_State *L = ls_.luaState();
-	nc::LuaUtils::pop(L); // last element
+	if (size_ > 0)
+		nc::LuaUtils::pop(L); // last element
 
 	nc::LuaUtils::pop(L); // array table
 }
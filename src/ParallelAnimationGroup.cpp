@@ -74,24 +74,43 @@ void ParallelAnimationGroup::play()
 }
 
 void ParallelAnimationGroup::update(float deltaTime)
+{
+	const bool isInsideSequential = insideSequential();
+	if (beginUpdate(deltaTime, isInsideSequential) == false)
+		return;
+
+	// Update all enabled animations anyway
+	for (auto &&anim : anims_)
+	{
+		if (anim->enabled)
+			anim->update(deltaTime);
+	}
+
+	endUpdate(isInsideSequential);
+}
+
+bool ParallelAnimationGroup::beginUpdate(float deltaTime, bool isInsideSequential)
 {
 	if (state_ == IAnimation::State::PLAYING)
 	{
 		if (shouldWaitDelay(deltaTime) ||
-		    (insideSequential() == false && loop_.shouldWaitDelay(deltaTime)))
+		    (isInsideSequential == false && loop_.shouldWaitDelay(deltaTime)))
 		{
-			return;
+			return false;
 		}
 	}
 
+	return true;
+}
+
+void ParallelAnimationGroup::endUpdate(bool isInsideSequential)
+{
 	bool allStopped = true;
 	bool allDisabled = true;
-	// Update all enabled animations anyway
 	for (auto &&anim : anims_)
 	{
 		if (anim->enabled)
 		{
-			anim->update(deltaTime);
 			allDisabled = false;
 			if (anim->state() != State::STOPPED)
 				allStopped = false;
@@ -102,7 +121,7 @@ void ParallelAnimationGroup::update(float deltaTime)
 	{
 		const Loop::Mode loopMode = loop_.mode();
 		// Disable looping if the animation is inside a sequential group
-		if (insideSequential())
+		if (isInsideSequential)
 			loop_.setMode(Loop::Mode::DISABLED);
 
 		switch (loop_.mode())
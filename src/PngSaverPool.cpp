@@ -0,0 +1,107 @@
+#include "PngSaverPool.h"
+#include <ncine/ServiceLocator.h>
+#include <ncine/ImageSaverPng.h>
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+PngSaverPool::PngSaverPool(unsigned int numBuffers)
+    : numBuffers_(numBuffers), nextBuffer_(0)
+{
+	if (numBuffers_ == 0)
+		numBuffers_ = nc::theServiceLocator().jobSystem().numThreads() * 2;
+	if (numBuffers_ < 2)
+		numBuffers_ = 2;
+
+	buffers_ = nctl::makeUnique<Buffer[]>(numBuffers_);
+}
+
+PngSaverPool::~PngSaverPool()
+{
+	waitAll();
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+unsigned char *PngSaverPool::acquireBuffer(int width, int height)
+{
+	FATAL_ASSERT(width > 0);
+	FATAL_ASSERT(height > 0);
+
+	Buffer &buffer = buffers_[nextBuffer_];
+	waitBuffer(buffer);
+
+	const unsigned int sizeInBytes = static_cast<unsigned int>(width * height * 4);
+	if (buffer.capacity < sizeInBytes)
+	{
+		buffer.pixels = nctl::makeUnique<unsigned char[]>(sizeInBytes);
+		buffer.capacity = sizeInBytes;
+	}
+	buffer.width = width;
+	buffer.height = height;
+
+	return buffer.pixels.get();
+}
+
+void PngSaverPool::submit(const char *filename)
+{
+	Buffer &buffer = buffers_[nextBuffer_];
+	ASSERT(buffer.pending == false);
+	ASSERT(buffer.pixels != nullptr);
+
+	buffer.filename = filename;
+	Buffer *bufferPtr = &buffer;
+
+	nc::IJobSystem &jobSystem = nc::theServiceLocator().jobSystem();
+	buffer.jobId = jobSystem.createJob(encodeJob, &bufferPtr, sizeof(Buffer *));
+	buffer.pending = true;
+	jobSystem.run(buffer.jobId);
+
+	nextBuffer_ = (nextBuffer_ + 1) % numBuffers_;
+}
+
+void PngSaverPool::waitAll()
+{
+	for (unsigned int i = 0; i < numBuffers_; i++)
+		waitBuffer(buffers_[i]);
+}
+
+unsigned int PngSaverPool::numPendingJobs() const
+{
+	unsigned int numPending = 0;
+	for (unsigned int i = 0; i < numBuffers_; i++)
+	{
+		if (buffers_[i].pending)
+			numPending++;
+	}
+	return numPending;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void PngSaverPool::waitBuffer(Buffer &buffer)
+{
+	if (buffer.pending)
+	{
+		nc::theServiceLocator().jobSystem().wait(buffer.jobId);
+		buffer.pending = false;
+	}
+}
+
+void PngSaverPool::encodeJob(nc::JobId /*job*/, const void *data)
+{
+	const Buffer *buffer = *static_cast<Buffer *const *>(data);
+
+	nc::ImageSaverPng saver;
+	nc::IImageSaver::Properties props;
+	props.width = buffer->width;
+	props.height = buffer->height;
+	props.pixels = buffer->pixels.get();
+	props.format = nc::IImageSaver::Format::RGBA8;
+	saver.saveToFile(props, buffer->filename.data());
+}
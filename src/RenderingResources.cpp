@@ -11,6 +11,9 @@
 
 nctl::UniquePtr<nc::GLShaderProgram> RenderingResources::spriteShaderProgram_;
 nctl::UniquePtr<nc::GLShaderProgram> RenderingResources::meshSpriteShaderProgram_;
+nctl::UniquePtr<nc::GLShaderProgram> RenderingResources::meshSpriteGridShaderProgram_;
+nctl::UniquePtr<nc::GLShaderProgram> RenderingResources::batchedSpritesShaderProgram_;
+nctl::UniquePtr<nc::GLShaderProgram> RenderingResources::instancedSpritesShaderProgram_;
 
 nc::Vector2f RenderingResources::canvasSize_(0.0f, 0.0f);
 nc::Matrix4x4f RenderingResources::projectionMatrix_ = nc::Matrix4x4f::Identity;
@@ -46,6 +49,9 @@ void RenderingResources::create()
 	ShaderLoad shadersToLoad[] = {
 		{ RenderingResources::spriteShaderProgram_, ShaderStrings::sprite_vs, ShaderStrings::sprite_fs, nc::GLShaderProgram::Introspection::ENABLED },
 		{ RenderingResources::meshSpriteShaderProgram_, ShaderStrings::meshsprite_vs, ShaderStrings::sprite_fs, nc::GLShaderProgram::Introspection::ENABLED },
+		{ RenderingResources::meshSpriteGridShaderProgram_, ShaderStrings::meshsprite_grid_vs, ShaderStrings::sprite_fs, nc::GLShaderProgram::Introspection::ENABLED },
+		{ RenderingResources::batchedSpritesShaderProgram_, ShaderStrings::batchedsprites_vs, ShaderStrings::sprite_fs, nc::GLShaderProgram::Introspection::ENABLED },
+		{ RenderingResources::instancedSpritesShaderProgram_, ShaderStrings::instancedsprites_vs, ShaderStrings::sprite_fs, nc::GLShaderProgram::Introspection::ENABLED },
 	};
 
 	const nc::GLShaderProgram::QueryPhase queryPhase = appCfg.graphics.opengl.deferShaderQueries
@@ -68,6 +74,9 @@ void RenderingResources::create()
 
 void RenderingResources::dispose()
 {
+	instancedSpritesShaderProgram_.reset(nullptr);
+	batchedSpritesShaderProgram_.reset(nullptr);
+	meshSpriteGridShaderProgram_.reset(nullptr);
 	meshSpriteShaderProgram_.reset(nullptr);
 	spriteShaderProgram_.reset(nullptr);
 
@@ -1,19 +1,62 @@
 #include <ncine/LuaUtils.h>
 #include <ncine/FileSystem.h>
+#include <ncine/IFile.h>
 #include "singletons.h"
 #include "Script.h"
 #include "ScriptManager.h"
 
+#include <lauxlib.h>
+
+namespace {
+
+const char *functionNames[] = { "init", "update" };
+static_assert(sizeof(functionNames) / sizeof(*functionNames) == static_cast<unsigned int>(Script::Function::COUNT), "Missing script function names");
+
+void pushGlobalTable(lua_State *L)
+{
+#if LUA_VERSION_NUM >= 502
+	nc::LuaUtils::rawGeti(L, nc::LuaUtils::registryIndex(), LUA_RIDX_GLOBALS);
+#else
+	nc::LuaUtils::getGlobal(L, "_G");
+#endif
+}
+
+/// Pushes a new environment table that falls back to the globals, then the chunk loaded into it or an error message
+/*! Assigning an environment has no `LuaUtils` equivalent and differs between Lua versions, the raw calls are isolated here */
+int loadInNewEnvironment(lua_State *L, const char *buffer, unsigned long int size, const char *chunkName)
+{
+	nc::LuaUtils::createTable(L, 0, 0);
+	nc::LuaUtils::createTable(L, 0, 1);
+	pushGlobalTable(L);
+	nc::LuaUtils::setField(L, -2, "__index");
+	lua_setmetatable(L, -2);
+
+	const int status = luaL_loadbuffer(L, buffer, size, chunkName);
+	if (nc::LuaUtils::isStatusOk(status))
+	{
+		lua_pushvalue(L, -2);
+#if LUA_VERSION_NUM >= 502
+		// The first upvalue of a main chunk is its environment
+		lua_setupvalue(L, -2, 1);
+#else
+		lua_setfenv(L, -2);
+#endif
+	}
+
+	return status;
+}
+
+}
+
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
 
 Script::Script()
-    : canRun_(false), name_(256), errorMessage_(256),
-      luaState_(nc::LuaStateManager::ApiType::NONE,
-                nc::LuaStateManager::StatisticsTracking::DISABLED,
-                nc::LuaStateManager::StandardLibraries::LOADED)
+    : canRun_(false), name_(256), errorMessage_(256), state_(nullptr)
 {
+	for (bool &hasFunction : hasFunctions_)
+		hasFunction = false;
 }
 
 Script::Script(const char *filename)
@@ -22,10 +65,20 @@ Script::Script(const char *filename)
 	load(filename);
 }
 
+Script::~Script()
+{
+	releaseReferences();
+}
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
 
+const char *Script::functionName(Function function)
+{
+	return functionNames[static_cast<int>(function)];
+}
+
 bool Script::load(const char *filename)
 {
 	const bool hasLoaded = nc::fs::isReadableFile(filename);
@@ -47,10 +100,7 @@ bool Script::reload()
 
 	const bool hasLoaded = nc::fs::isReadableFile(filename.data());
 	if (hasLoaded)
-	{
-		luaState_.reopen();
 		run(filename.data(), name_.data());
-	}
 
 	return hasLoaded;
 }
@@ -61,9 +111,115 @@ bool Script::reload()
 
 bool Script::run(const char *filename, const char *chunkName)
 {
-	ScriptManager::exposeConstants(luaState_.state());
-	ScriptManager::exposeFunctions(luaState_.state());
-	canRun_ = luaState_.runFromFile(filename, chunkName, &errorMessage_);
+	releaseReferences();
+	profile_.reset();
+	// The main chunk does not run on behalf of any sprite
+	ScriptManager::setRunningSprite(nullptr);
+	if (theCfg.sharedScriptState)
+	{
+		luaState_.reset(nullptr);
+		return runShared(filename, chunkName);
+	}
+
+	if (luaState_ == nullptr)
+	{
+		luaState_ = nctl::makeUnique<nc::LuaStateManager>(nc::LuaStateManager::ApiType::NONE,
+		                                                  nc::LuaStateManager::StatisticsTracking::DISABLED,
+		                                                  nc::LuaStateManager::StandardLibraries::LOADED);
+	}
+	else
+		luaState_->reopen();
+
+	state_ = luaState_->state();
+	ScriptManager::applyGcSettings(state_);
+	ScriptManager::applyJitMode(state_);
+	ScriptManager::exposeConstants(state_);
+	ScriptManager::exposeFunctions(state_);
+	ScriptManager::setInstructionBudget(state_);
+	canRun_ = luaState_->runFromFile(filename, chunkName, &errorMessage_);
+
+	if (canRun_)
+	{
+		pushGlobalTable(state_);
+		retrieveFunctions(state_);
+	}
+
+	return canRun_;
+}
+
+bool Script::runShared(const char *filename, const char *chunkName)
+{
+	lua_State *L = theScriptingMgr->sharedLuaState();
+	state_ = L;
+	canRun_ = false;
+
+	nctl::UniquePtr<nc::IFile> fileHandle = nc::IFile::createFileHandle(filename);
+	fileHandle->open(nc::IFile::OpenMode::READ | nc::IFile::OpenMode::BINARY);
+	if (fileHandle->isOpened() == false)
+	{
+		errorMessage_.format("Cannot open file \"%s\"", filename);
+		return false;
+	}
+	const long int fileSize = fileHandle->size();
+	nctl::UniquePtr<char[]> buffer = nctl::makeUnique<char[]>(fileSize);
+	fileHandle->read(buffer.get(), fileSize);
+	fileHandle->close();
+
+	// The environment falls back to the globals table, where the script functions are exposed
+	int status = loadInNewEnvironment(L, buffer.get(), fileSize, chunkName);
+	if (nc::LuaUtils::isStatusOk(status))
+	{
+		ScriptManager::setInstructionBudget(L);
+		status = nc::LuaUtils::pcall(L, 0, 0);
+	}
+
+	if (nc::LuaUtils::isStatusOk(status) == false)
+	{
+		errorMessage_ = nc::LuaUtils::retrieve<const char *>(L, -1);
+		nc::LuaUtils::pop(L, 2);
+		return false;
+	}
+
+	// The environment is kept alive by the functions defined in it
+	retrieveFunctions(L);
+	canRun_ = true;
 
 	return canRun_;
 }
+
+void Script::retrieveFunctions(lua_State *L)
+{
+	for (unsigned int i = 0; i < static_cast<unsigned int>(Function::COUNT); i++)
+	{
+		nc::LuaUtils::push(L, functionKey(static_cast<Function>(i)));
+		nc::LuaUtils::getField(L, -2, functionNames[i]);
+		hasFunctions_[i] = nc::LuaUtils::isFunction(L, -1);
+		if (hasFunctions_[i])
+			nc::LuaUtils::setTable(L, nc::LuaUtils::registryIndex());
+		else
+			nc::LuaUtils::pop(L, 2);
+	}
+	nc::LuaUtils::pop(L);
+}
+
+void Script::releaseReferences()
+{
+	// An own state does not need to be cleaned, as it is going to be reopened or destroyed
+	if (state_ != nullptr && luaState_ == nullptr)
+	{
+		for (unsigned int i = 0; i < static_cast<unsigned int>(Function::COUNT); i++)
+		{
+			if (hasFunctions_[i])
+			{
+				nc::LuaUtils::push(state_, functionKey(static_cast<Function>(i)));
+				nc::LuaUtils::pushNil(state_);
+				nc::LuaUtils::setTable(state_, nc::LuaUtils::registryIndex());
+			}
+		}
+	}
+
+	for (bool &hasFunction : hasFunctions_)
+		hasFunction = false;
+	state_ = nullptr;
+	canRun_ = false;
+}
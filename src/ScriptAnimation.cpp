@@ -1,10 +1,23 @@
 #include <ncine/LuaUtils.h>
 #include <ncine/LuaDebug.h>
+#include <ncine/TimeStamp.h>
 #include "ScriptAnimation.h"
 #include "Script.h"
 #include "ScriptManager.h"
 #include "Sprite.h"
 
+#include <lua.h>
+
+namespace {
+
+/// Returns the number of bytes in use by a Lua state
+int64_t usedMemory(lua_State *L)
+{
+	return static_cast<int64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+}
+
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
@@ -42,13 +55,13 @@ void ScriptAnimation::play()
 {
 	CurveAnimation::play();
 	if (sprite_)
-		runScript("init", curve_.value());
+		runScript(Script::Function::INIT, curve_.value());
 }
 
 void ScriptAnimation::perform()
 {
 	if (sprite_ && sprite_->visible)
-		runScript("update", curve_.value());
+		runScript(Script::Function::UPDATE, curve_.value());
 }
 
 void ScriptAnimation::setSprite(Sprite *sprite)
@@ -56,9 +69,9 @@ void ScriptAnimation::setSprite(Sprite *sprite)
 	if (sprite_ != sprite)
 	{
 		if (sprite_)
-			sprite_->decrementGridAnimCounter();
+			sprite_->decrementScriptAnimCounter();
 		if (sprite)
-			sprite->incrementGridAnimCounter();
+			sprite->incrementScriptAnimCounter();
 
 		sprite_ = sprite;
 	}
@@ -73,28 +86,45 @@ void ScriptAnimation::setScript(Script *script)
 // PRIVATE FUNCTIONS
 ///////////////////////////////////////////////////////////
 
-bool ScriptAnimation::runScript(const char *functionName, float value)
+bool ScriptAnimation::runScript(Script::Function function, float value)
 {
 	if (sprite_ == nullptr || script_ == nullptr)
 		return false;
 
-	lua_State *L = script_->luaState_.state();
-	const int type = nc::LuaUtils::getGlobal(L, functionName);
-
-	if (nc::LuaUtils::isFunction(type))
+	if (script_->canRun() && script_->hasFunctions_[static_cast<int>(function)])
 	{
-		ScriptManager::pushSprite(L, sprite_);
+		lua_State *L = script_->state_;
+		nc::LuaUtils::push(L, script_->functionKey(function));
+		nc::LuaUtils::getTable(L, nc::LuaUtils::registryIndex());
+		ScriptManager::setRunningSprite(sprite_);
 		nc::LuaUtils::push(L, value);
+
+		const int64_t memoryBefore = usedMemory(L);
+		ScriptManager::setInstructionBudget(L);
+		const nc::TimeStamp startTime = nc::TimeStamp::now();
 		const int status = nc::LuaUtils::pcall(L, 1, 0);
+		const float callTime = startTime.secondsSince();
+		// Sprite functions called outside of an animation call, like from a kept vertex buffer view, operate on no sprite
+		ScriptManager::setRunningSprite(nullptr);
+		const int64_t callMemoryDelta = usedMemory(L) - memoryBefore;
+		profile_.addCall(callTime, callMemoryDelta);
+		script_->profile_.addCall(callTime, callMemoryDelta);
+
+		// The script could have changed the vertices
+		sprite_->markVerticesModified();
 		if (nc::LuaUtils::isStatusOk(status) == false)
 		{
-			LOGE_X("Error running \"%s\" function for script \"%s\" (%s):\n%s", functionName, script_->name().data(),
+			LOGE_X("Error running \"%s\" function for script \"%s\" (%s):\n%s", Script::functionName(function), script_->name().data(),
 			       nc::LuaDebug::statusToString(status), nc::LuaUtils::retrieve<const char *>(L, -1));
+			// A script that exceeds its budget would stall every frame, it is stopped until reloaded
+			if (ScriptManager::instructionBudgetExceeded())
+			{
+				script_->errorMessage_ = nc::LuaUtils::retrieve<const char *>(L, -1);
+				script_->canRun_ = false;
+			}
 			nc::LuaUtils::pop(L);
 		}
 	}
-	else
-		nc::LuaUtils::pop(L);
 
 	return true;
 }
@@ -1,4 +1,6 @@
+#include <cstring>
 #include <ncine/LuaUtils.h>
+#include <ncine/LuaStateManager.h>
 #include <ncine/LuaVector2Utils.h>
 #include <ncine/LuaColorfUtils.h>
 #include <ncine/LuaRectUtils.h>
@@ -10,8 +12,10 @@
 #include "Texture.h"
 #include "Canvas.h"
 
+#include <lauxlib.h>
+
 namespace {
-const char *spriteKey = "k";
+const char *vertexBufferKey = "b";
 
 static const char *vertexX = "x";
 static const char *vertexY = "y";
@@ -29,15 +33,61 @@ enum class Components
 	V
 };
 
+#ifdef WITH_LUAJIT
+static_assert(sizeof(Sprite::Vertex) == 2 * sizeof(float), "The FFI vertex type does not match Sprite::Vertex");
+static_assert(sizeof(Sprite::TexCoords) == 2 * sizeof(float), "The FFI texture coordinates type does not match Sprite::TexCoords");
+
+/// Declares the FFI types of the sprite grid and the functions that cast the raw arrays to them
+/*! The arrays start from index 0 and are only valid until the end of the current script function */
+const char *ffiChunk = R"(
+local ffi = require("ffi")
+ffi.cdef[[
+typedef struct { float x, y; } sg_vertex;
+typedef struct { float u, v; } sg_texcoords;
+]]
+
+local vertices_data = get_vertices_data
+local texcoords_data = get_texcoords_data
+
+function get_vertex_array()
+	local data, count = vertices_data()
+	return ffi.cast("sg_vertex *", data), count
+end
+
+function get_texcoords_array()
+	local data, count = texcoords_data()
+	return ffi.cast("sg_texcoords *", data), count
+end
+)";
+#endif
+
+/// Pushes a view of the vertex buffer that accesses a component, sharing the metatable at the top of the stack
+/*! Raw Lua calls are isolated here, as `LuaUtils` cannot create userdata or assign metatables */
+void pushVertexBufferView(lua_State *L, Components component)
+{
+	Components *view = static_cast<Components *>(lua_newuserdata(L, sizeof(Components)));
+	*view = component;
+	lua_pushvalue(L, -2);
+	lua_setmetatable(L, -2);
+}
+
+/// Returns the component accessed by a vertex buffer view
+Components retrieveViewComponent(lua_State *L)
+{
+	return *static_cast<Components *>(nc::LuaUtils::retrieve<void *>(L, 1));
+}
+
 void verticesHelper(lua_State *L, Sprite *sprite, Components components)
 {
 	if (sprite)
 	{
-		const nctl::Array<Sprite::Vertex> &vertices = sprite->interleavedVertices();
+		const nctl::Array<Sprite::Vertex> &vertices = sprite->vertices();
+		const nctl::Array<Sprite::TexCoords> &texCoords = sprite->texCoords();
 		nc::LuaUtils::createTable(L, vertices.size(), 0);
 		for (unsigned int i = 0; i < vertices.size(); i++)
 		{
 			const Sprite::Vertex &vertex = vertices[i];
+			const Sprite::TexCoords &texCoord = texCoords[i];
 			switch (components)
 			{
 				case Components::XYUV:
@@ -45,8 +95,8 @@ void verticesHelper(lua_State *L, Sprite *sprite, Components components)
 					nc::LuaUtils::createTable(L, 0, 4);
 					nc::LuaUtils::pushField(L, vertexX, vertex.x);
 					nc::LuaUtils::pushField(L, vertexY, vertex.y);
-					nc::LuaUtils::pushField(L, vertexU, vertex.u);
-					nc::LuaUtils::pushField(L, vertexV, vertex.v);
+					nc::LuaUtils::pushField(L, vertexU, texCoord.u);
+					nc::LuaUtils::pushField(L, vertexV, texCoord.v);
 				}
 					break;
 				case Components::XY:
@@ -59,8 +109,8 @@ void verticesHelper(lua_State *L, Sprite *sprite, Components components)
 				case Components::UV:
 				{
 					nc::LuaUtils::createTable(L, 0, 2);
-					nc::LuaUtils::pushField(L, vertexU, vertex.u);
-					nc::LuaUtils::pushField(L, vertexV, vertex.v);
+					nc::LuaUtils::pushField(L, vertexU, texCoord.u);
+					nc::LuaUtils::pushField(L, vertexV, texCoord.v);
 				}
 					break;
 				case Components::X:
@@ -70,10 +120,10 @@ void verticesHelper(lua_State *L, Sprite *sprite, Components components)
 					nc::LuaUtils::push(L, vertex.y);
 					break;
 				case Components::U:
-					nc::LuaUtils::push(L, vertex.u);
+					nc::LuaUtils::push(L, texCoord.u);
 					break;
 				case Components::V:
-					nc::LuaUtils::push(L, vertex.v);
+					nc::LuaUtils::push(L, texCoord.v);
 					break;
 			}
 
@@ -86,9 +136,16 @@ void setVerticesHelper(lua_State *L, Sprite *sprite, Components components)
 {
 	if (sprite)
 	{
-		nctl::Array<Sprite::Vertex> &vertices = sprite->interleavedVertices();
+		nctl::Array<Sprite::Vertex> &vertices = sprite->vertices();
+		nctl::Array<Sprite::TexCoords> &texCoords = sprite->texCoords();
 		if (nc::LuaUtils::isTable(L, -1) && nc::LuaUtils::rawLen(L, -1) == vertices.size())
 		{
+			if (components == Components::XYUV || components == Components::UV ||
+			    components == Components::U || components == Components::V)
+			{
+				sprite->markTexCoordsModified();
+			}
+
 			for (unsigned int i = 0; i < vertices.size(); i++)
 			{
 				nc::LuaUtils::rawGeti(L, -1, i + 1); // Lua arrays start from index 1
@@ -102,8 +159,8 @@ void setVerticesHelper(lua_State *L, Sprite *sprite, Components components)
 						const float v = nc::LuaUtils::retrieveField<float>(L, -1, vertexV);
 						vertices[i].x = x;
 						vertices[i].y = y;
-						vertices[i].u = u;
-						vertices[i].v = v;
+						texCoords[i].u = u;
+						texCoords[i].v = v;
 					}
 						break;
 					case Components::XY:
@@ -118,8 +175,8 @@ void setVerticesHelper(lua_State *L, Sprite *sprite, Components components)
 					{
 						const float u = nc::LuaUtils::retrieveField<float>(L, -1, vertexU);
 						const float v = nc::LuaUtils::retrieveField<float>(L, -1, vertexV);
-						vertices[i].u = u;
-						vertices[i].v = v;
+						texCoords[i].u = u;
+						texCoords[i].v = v;
 					}
 						break;
 					case Components::X:
@@ -129,10 +186,10 @@ void setVerticesHelper(lua_State *L, Sprite *sprite, Components components)
 						vertices[i].y = nc::LuaUtils::retrieve<float>(L, -1);
 						break;
 					case Components::U:
-						vertices[i].u = nc::LuaUtils::retrieve<float>(L, -1);
+						texCoords[i].u = nc::LuaUtils::retrieve<float>(L, -1);
 						break;
 					case Components::V:
-						vertices[i].v = nc::LuaUtils::retrieve<float>(L, -1);
+						texCoords[i].v = nc::LuaUtils::retrieve<float>(L, -1);
 						break;
 				}
 				nc::LuaUtils::pop(L);
@@ -176,6 +233,8 @@ static const char *isFlippedY = "get_flipped_y";
 static const char *rgbBlendingPreset = "get_rgb_blending";
 static const char *alphaBlendingPreset = "get_alpha_blending";
 static const char *numVertices = "get_num_vertices";
+static const char *gridWidth = "get_grid_width";
+static const char *gridHeight = "get_grid_height";
 static const char *vertices = "get_vertices";
 static const char *verticesXY = "get_vertices_xy";
 static const char *verticesUV = "get_vertices_uv";
@@ -183,6 +242,11 @@ static const char *verticesX = "get_vertices_x";
 static const char *verticesY = "get_vertices_y";
 static const char *verticesU = "get_vertices_u";
 static const char *verticesV = "get_vertices_v";
+static const char *vertexBuffer = "get_vertex_buffer";
+#ifdef WITH_LUAJIT
+static const char *verticesData = "get_vertices_data";
+static const char *texCoordsData = "get_texcoords_data";
+#endif
 
 static const char *setPosition = "set_position";
 static const char *setPositionX = "set_x";
@@ -210,6 +274,23 @@ static const char *setVerticesV = "set_vertices_v";
 
 }
 
+Sprite *ScriptManager::runningSprite_ = nullptr;
+bool ScriptManager::instructionBudgetExceeded_ = false;
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+ScriptManager::ScriptManager()
+{
+}
+
+ScriptManager::~ScriptManager()
+{
+	// Scripts are destroyed explicitly while the shared state still exists
+	scripts_.clear();
+}
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
@@ -217,6 +298,7 @@ static const char *setVerticesV = "set_vertices_v";
 void ScriptManager::clear()
 {
 	scripts_.clear();
+	sharedLuaState_.reset(nullptr);
 }
 
 int ScriptManager::scriptIndex(const Script *script) const
@@ -237,28 +319,92 @@ int ScriptManager::scriptIndex(const Script *script) const
 	return index;
 }
 
-///////////////////////////////////////////////////////////
-// PRIVATE FUNCTIONS
-///////////////////////////////////////////////////////////
+lua_State *ScriptManager::sharedLuaState()
+{
+	if (sharedLuaState_ == nullptr)
+	{
+		sharedLuaState_ = nctl::makeUnique<nc::LuaStateManager>(nc::LuaStateManager::ApiType::NONE,
+		                                                         nc::LuaStateManager::StatisticsTracking::DISABLED,
+		                                                         nc::LuaStateManager::StandardLibraries::LOADED);
+		applyGcSettings(sharedLuaState_->state());
+		applyJitMode(sharedLuaState_->state());
+		exposeConstants(sharedLuaState_->state());
+		exposeFunctions(sharedLuaState_->state());
+	}
+
+	return sharedLuaState_->state();
+}
+
+void ScriptManager::applyGcSettings()
+{
+	if (sharedLuaState_ != nullptr)
+		applyGcSettings(sharedLuaState_->state());
+	for (nctl::UniquePtr<Script> &script : scripts_)
+	{
+		if (script->isShared() == false && script->luaState() != nullptr)
+			applyGcSettings(script->luaState());
+	}
+}
 
-Sprite *ScriptManager::retrieveSprite(lua_State *L)
+void ScriptManager::applyGcSettings(lua_State *L)
 {
-	Sprite *sprite = nullptr;
+#if LUA_VERSION_NUM >= 504
+	if (theCfg.scriptGenerationalGc)
+		lua_gc(L, LUA_GCGEN, 0, 0); // zero keeps the default multipliers
+	else
+		lua_gc(L, LUA_GCINC, theCfg.scriptGcPause, theCfg.scriptGcStepMultiplier, 0);
+#else
+	// The generational mode is only available from Lua 5.4
+	lua_gc(L, LUA_GCSETPAUSE, theCfg.scriptGcPause);
+	lua_gc(L, LUA_GCSETSTEPMUL, theCfg.scriptGcStepMultiplier);
+#endif
+}
 
-	nc::LuaUtils::push(L, reinterpret_cast<void *>(&spriteKey));
-	const int type = nc::LuaUtils::getTable(L, nc::LuaUtils::registryIndex());
-	if (nc::LuaUtils::isLightUserData(type))
-		sprite = reinterpret_cast<Sprite *>(nc::LuaUtils::retrieveUserData(L, -1));
-	nc::LuaUtils::pop(L, 1);
+void ScriptManager::setInstructionBudget(lua_State *L)
+{
+	instructionBudgetExceeded_ = false;
+	if (theCfg.scriptInstructionBudget > 0)
+		lua_sethook(L, instructionBudgetHook, LUA_MASKCOUNT, theCfg.scriptInstructionBudget);
+	else
+		lua_sethook(L, nullptr, 0, 0);
+}
 
-	return sprite;
+void ScriptManager::applyJitMode()
+{
+	if (sharedLuaState_ != nullptr)
+		applyJitMode(sharedLuaState_->state());
+	for (nctl::UniquePtr<Script> &script : scripts_)
+	{
+		if (script->isShared() == false && script->luaState() != nullptr)
+			applyJitMode(script->luaState());
+	}
 }
 
-void ScriptManager::pushSprite(lua_State *L, Sprite *sprite)
+void ScriptManager::applyJitMode(lua_State *L)
 {
-	nc::LuaUtils::push(L, reinterpret_cast<void *>(&spriteKey));
-	nc::LuaUtils::push(L, sprite);
-	nc::LuaUtils::setTable(L, nc::LuaUtils::registryIndex());
+#ifdef WITH_LUAJIT
+	nc::LuaUtils::getGlobal(L, "jit");
+	if (nc::LuaUtils::isTable(L, -1))
+	{
+		nc::LuaUtils::getField(L, -1, (theCfg.scriptInstructionBudget > 0) ? "off" : "on");
+		if (nc::LuaUtils::isStatusOk(nc::LuaUtils::pcall(L, 0, 0)) == false)
+		{
+			LOGE_X("Cannot switch the JIT compiler mode: %s", nc::LuaUtils::retrieve<const char *>(L, -1));
+			nc::LuaUtils::pop(L);
+		}
+	}
+	nc::LuaUtils::pop(L);
+#endif
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void ScriptManager::instructionBudgetHook(lua_State *L, lua_Debug *)
+{
+	instructionBudgetExceeded_ = true;
+	luaL_error(L, "the script has exceeded the budget of %d instructions", theCfg.scriptInstructionBudget);
 }
 
 void ScriptManager::exposeConstants(lua_State *L)
@@ -300,6 +446,8 @@ void ScriptManager::exposeFunctions(lua_State *L)
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::rgbBlendingPreset, rgbBlendingPreset);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::alphaBlendingPreset, alphaBlendingPreset);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::numVertices, numVertices);
+	nc::LuaUtils::addGlobalFunction(L, LuaNames::gridWidth, gridWidth);
+	nc::LuaUtils::addGlobalFunction(L, LuaNames::gridHeight, gridHeight);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::vertices, vertices);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesXY, verticesXY);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesUV, verticesUV);
@@ -307,6 +455,7 @@ void ScriptManager::exposeFunctions(lua_State *L)
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesY, verticesY);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesU, verticesU);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesV, verticesV);
+	nc::LuaUtils::addGlobalFunction(L, LuaNames::vertexBuffer, vertexBuffer);
 
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::setPosition, setPosition);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::setPositionX, setPositionX);
@@ -331,8 +480,65 @@ void ScriptManager::exposeFunctions(lua_State *L)
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::setVerticesY, setVerticesY);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::setVerticesU, setVerticesU);
 	nc::LuaUtils::addGlobalFunction(L, LuaNames::setVerticesV, setVerticesV);
+
+#ifdef WITH_LUAJIT
+	exposeFfiFunctions(L);
+#endif
+}
+
+#ifdef WITH_LUAJIT
+void ScriptManager::exposeFfiFunctions(lua_State *L)
+{
+	// The FFI is only available if nCine has created the state with LuaJIT
+	nc::LuaUtils::getGlobal(L, "jit");
+	const bool isLuaJit = nc::LuaUtils::isTable(L, -1);
+	nc::LuaUtils::pop(L);
+	if (isLuaJit == false)
+		return;
+
+	nc::LuaUtils::addGlobalFunction(L, LuaNames::verticesData, verticesData);
+	nc::LuaUtils::addGlobalFunction(L, LuaNames::texCoordsData, texCoordsData);
+
+	int status = luaL_loadbuffer(L, ffiChunk, strlen(ffiChunk), "ffi");
+	if (nc::LuaUtils::isStatusOk(status))
+		status = nc::LuaUtils::pcall(L, 0, 0);
+	if (nc::LuaUtils::isStatusOk(status) == false)
+	{
+		LOGE_X("Cannot declare the FFI vertex functions: %s", nc::LuaUtils::retrieve<const char *>(L, -1));
+		nc::LuaUtils::pop(L);
+	}
+}
+
+int ScriptManager::verticesData(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	void *data = sprite ? sprite->vertices().data() : nullptr;
+	const unsigned int numVertices = sprite ? sprite->vertices().size() : 0;
+	nc::LuaUtils::push(L, data);
+	nc::LuaUtils::push(L, numVertices);
+
+	return 2;
 }
 
+int ScriptManager::texCoordsData(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	void *data = nullptr;
+	unsigned int numTexCoords = 0;
+	if (sprite)
+	{
+		// Texture coordinates are written directly through the pointer
+		sprite->markTexCoordsModified();
+		data = sprite->texCoords().data();
+		numTexCoords = sprite->texCoords().size();
+	}
+	nc::LuaUtils::push(L, data);
+	nc::LuaUtils::push(L, numTexCoords);
+
+	return 2;
+}
+#endif
+
 int ScriptManager::canvasWidth(lua_State *L)
 {
 	nc::LuaUtils::push(L, theCanvas->texWidth());
@@ -528,12 +734,30 @@ int ScriptManager::alphaBlendingPreset(lua_State *L)
 int ScriptManager::numVertices(lua_State *L)
 {
 	Sprite *sprite = retrieveSprite(L);
-	const unsigned int numVertices = sprite ? sprite->interleavedVertices().size() : 0;
+	const unsigned int numVertices = sprite ? sprite->vertices().size() : 0;
 	nc::LuaUtils::push(L, numVertices);
 
 	return 1;
 }
 
+int ScriptManager::gridWidth(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	const int gridWidth = sprite ? sprite->gridWidth() : 0;
+	nc::LuaUtils::push(L, gridWidth);
+
+	return 1;
+}
+
+int ScriptManager::gridHeight(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	const int gridHeight = sprite ? sprite->gridHeight() : 0;
+	nc::LuaUtils::push(L, gridHeight);
+
+	return 1;
+}
+
 int ScriptManager::vertices(lua_State *L)
 {
 	Sprite *sprite = retrieveSprite(L);
@@ -589,6 +813,117 @@ int ScriptManager::verticesV(lua_State *L)
 	return 1;
 }
 
+int ScriptManager::vertexBuffer(lua_State *L)
+{
+	// The buffer is created once per script and reused, it does not hold any data
+	nc::LuaUtils::push(L, reinterpret_cast<void *>(&vertexBufferKey));
+	nc::LuaUtils::getTable(L, nc::LuaUtils::registryIndex());
+	if (nc::LuaUtils::isTable(L, -1))
+		return 1;
+	nc::LuaUtils::pop(L);
+
+	nc::LuaUtils::push(L, reinterpret_cast<void *>(&vertexBufferKey));
+	nc::LuaUtils::createTable(L, 0, 4);
+
+	// All views share the same metatable, every one of them stores the component it accesses
+	nc::LuaUtils::createTable(L, 0, 3);
+	nc::LuaUtils::addFunction(L, "__index", vertexBufferIndex);
+	nc::LuaUtils::addFunction(L, "__newindex", vertexBufferNewIndex);
+	nc::LuaUtils::addFunction(L, "__len", vertexBufferLength);
+
+	const char *names[] = { vertexX, vertexY, vertexU, vertexV };
+	const Components components[] = { Components::X, Components::Y, Components::U, Components::V };
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		pushVertexBufferView(L, components[i]);
+		nc::LuaUtils::setField(L, -3, names[i]);
+	}
+	nc::LuaUtils::pop(L); // metatable
+	nc::LuaUtils::setTable(L, nc::LuaUtils::registryIndex());
+
+	nc::LuaUtils::push(L, reinterpret_cast<void *>(&vertexBufferKey));
+	nc::LuaUtils::getTable(L, nc::LuaUtils::registryIndex());
+
+	return 1;
+}
+
+int ScriptManager::vertexBufferIndex(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	const Components component = retrieveViewComponent(L);
+	const int64_t index = nc::LuaUtils::retrieve<int64_t>(L, 2);
+	if (sprite == nullptr || index < 1 || index > static_cast<int64_t>(sprite->vertices().size()))
+	{
+		nc::LuaUtils::pushNil(L);
+		return 1;
+	}
+
+	// Lua arrays start from index 1
+	const Sprite::Vertex &vertex = sprite->vertices()[index - 1];
+	const Sprite::TexCoords &texCoord = sprite->texCoords()[index - 1];
+	switch (component)
+	{
+		case Components::X:
+			nc::LuaUtils::push(L, vertex.x);
+			break;
+		case Components::Y:
+			nc::LuaUtils::push(L, vertex.y);
+			break;
+		case Components::U:
+			nc::LuaUtils::push(L, texCoord.u);
+			break;
+		case Components::V:
+		default:
+			nc::LuaUtils::push(L, texCoord.v);
+			break;
+	}
+
+	return 1;
+}
+
+int ScriptManager::vertexBufferNewIndex(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	const Components component = retrieveViewComponent(L);
+	const int64_t index = nc::LuaUtils::retrieve<int64_t>(L, 2);
+	if (sprite == nullptr || index < 1 || index > static_cast<int64_t>(sprite->vertices().size()))
+		return 0;
+
+	// Lua arrays start from index 1
+	Sprite::Vertex &vertex = sprite->vertices()[index - 1];
+	Sprite::TexCoords &texCoord = sprite->texCoords()[index - 1];
+	const float value = nc::LuaUtils::retrieve<float>(L, 3);
+	switch (component)
+	{
+		case Components::X:
+			vertex.x = value;
+			break;
+		case Components::Y:
+			vertex.y = value;
+			break;
+		case Components::U:
+			texCoord.u = value;
+			sprite->markTexCoordsModified();
+			break;
+		case Components::V:
+		default:
+			texCoord.v = value;
+			sprite->markTexCoordsModified();
+			break;
+	}
+
+	return 0;
+}
+
+int ScriptManager::vertexBufferLength(lua_State *L)
+{
+	Sprite *sprite = retrieveSprite(L);
+	const unsigned int numVertices = sprite ? sprite->vertices().size() : 0;
+	nc::LuaUtils::push(L, numVertices);
+
+	return 1;
+}
+
 int ScriptManager::setPosition(lua_State *L)
 {
 	Sprite *sprite = retrieveSprite(L);
@@ -1,5 +1,14 @@
 #include "SequentialAnimationGroup.h"
 
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+SequentialAnimationGroup::SequentialAnimationGroup()
+    : nextEnabled_(8), previousEnabled_(8)
+{
+}
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
@@ -17,15 +26,10 @@ void SequentialAnimationGroup::pause()
 	if (state_ != State::PLAYING)
 		return;
 
-	for (auto &&anim : anims_)
-	{
-		// The sequential group pauses the first and only playing animation
-		if (anim->state() == State::PLAYING)
-		{
-			anim->pause();
-			break;
-		}
-	}
+	// The sequential group pauses the first and only playing animation
+	const int playingIndex = findAnim(State::PLAYING);
+	if (playingIndex >= 0)
+		anims_[playingIndex]->pause();
 
 	state_ = State::PAUSED;
 }
@@ -43,44 +47,31 @@ void SequentialAnimationGroup::play()
 				// Stop all animations to get the initial state
 				stopAnimations();
 
+				updateEnabledAnims();
 				if (loop_.direction() == Loop::Direction::FORWARD)
 				{
 					loop_.goForward(true);
-
-					// Find first enabled animation
-					unsigned int firstEnabled = 0;
-					while (firstEnabled < anims_.size() && anims_[firstEnabled]->enabled == false)
-						firstEnabled++;
-
-					if (firstEnabled < anims_.size())
-						anims_[firstEnabled]->play();
+					cursor_ = firstEnabled_;
 				}
 				else
 				{
 					loop_.goForward(false);
 					if (shouldReverseAnimDirection())
 						reverseAnimDirection(*anims_.back());
-
-					// Find last enabled animation
-					int lastEnabled = anims_.size() - 1;
-					while (lastEnabled >= 0 && anims_[lastEnabled]->enabled == false)
-						lastEnabled--;
-
-					if (lastEnabled >= 0)
-						anims_[lastEnabled]->play();
+					cursor_ = lastEnabled_;
 				}
+
+				if (cursor_ >= 0)
+					anims_[cursor_]->play();
 			}
 			break;
 		case State::PAUSED:
-			for (auto &&anim : anims_)
-			{
-				if (anim->state() == State::PAUSED)
-				{
-					anim->play();
-					break;
-				}
-			}
+		{
+			const int pausedIndex = findAnim(State::PAUSED);
+			if (pausedIndex >= 0)
+				anims_[pausedIndex]->play();
 			break;
+		}
 		case State::PLAYING:
 			break;
 	}
@@ -90,37 +81,46 @@ void SequentialAnimationGroup::play()
 
 void SequentialAnimationGroup::update(float deltaTime)
 {
-	int playingIndex = -1;
+	const bool isInsideSequential = insideSequential();
+	if (beginUpdate(deltaTime, isInsideSequential) == false)
+		return;
+
+	// Update all enabled animations anyway (always after checking if one is playing)
+	for (unsigned int i = 0; i < anims_.size(); i++)
+	{
+		if (anims_[i]->enabled)
+			anims_[i]->update(deltaTime);
+		else if (anims_[i]->state() == IAnimation::State::PLAYING)
+			anims_[i]->stop();
+	}
+
+	endUpdate(isInsideSequential);
+}
+
+bool SequentialAnimationGroup::beginUpdate(float deltaTime, bool isInsideSequential)
+{
+	playingIndex_ = -1;
 
 	if (state_ == IAnimation::State::PLAYING)
 	{
 		if (shouldWaitDelay(deltaTime) ||
-		    (insideSequential() == false && loop_.shouldWaitDelay(deltaTime)))
+		    (isInsideSequential == false && loop_.shouldWaitDelay(deltaTime)))
 		{
-			return;
+			return false;
 		}
 		else
 		{
 			// Check if there is an animation currently in playing state
-			for (unsigned int i = 0; i < anims_.size(); i++)
-			{
-				if (anims_[i]->state() == State::PLAYING)
-				{
-					playingIndex = i;
-					break;
-				}
-			}
+			playingIndex_ = findAnim(State::PLAYING);
 		}
 	}
 
-	// Update all enabled animations anyway (always after checking if one is playing)
-	for (unsigned int i = 0; i < anims_.size(); i++)
-	{
-		if (anims_[i]->enabled)
-			anims_[i]->update(deltaTime);
-		else if (anims_[i]->state() == IAnimation::State::PLAYING)
-			anims_[i]->stop();
-	}
+	return true;
+}
+
+void SequentialAnimationGroup::endUpdate(bool isInsideSequential)
+{
+	int playingIndex = playingIndex_;
 
 	if (playingIndex > -1 && state_ == IAnimation::State::PLAYING)
 	{
@@ -129,7 +129,7 @@ void SequentialAnimationGroup::update(float deltaTime)
 		{
 			const Loop::Mode loopMode = loop_.mode();
 			// Disable looping if the animation is inside a sequential group
-			if (insideSequential())
+			if (isInsideSequential)
 				loop_.setMode(Loop::Mode::DISABLED);
 
 			if (shouldReverseAnimDirection())
@@ -152,93 +152,125 @@ void SequentialAnimationGroup::update(float deltaTime)
 					reverseAnimDirection(*anims_[playingIndex]);
 
 				anims_[playingIndex]->play();
+				cursor_ = playingIndex;
 			}
 		}
 	}
 }
 
+void SequentialAnimationGroup::invalidateAnims()
+{
+	enabledAnimsAreValid_ = false;
+}
+
 ///////////////////////////////////////////////////////////
 // PRIVATE FUNCTIONS
 ///////////////////////////////////////////////////////////
 
-int SequentialAnimationGroup::nextPlayingIndex(int playingIndex)
+int SequentialAnimationGroup::findAnim(State state)
 {
-	// Search the index of the first animation that is enabled
-	int firstEnabled = -1;
+	// The animation played last by the group is usually the one in the requested state
+	if (cursor_ >= 0 && cursor_ < anims_.size() && anims_[cursor_]->state() == state)
+		return cursor_;
+
+	// Animations can also be played or moved from outside the group
 	for (unsigned int i = 0; i < anims_.size(); i++)
 	{
-		if (anims_[i]->enabled)
+		if (anims_[i]->state() == state)
 		{
-			firstEnabled = i;
-			break;
+			cursor_ = i;
+			return i;
 		}
 	}
 
-	// Return an invalid index if there are no enabled animations in the group
-	if (firstEnabled < 0)
-		return -1;
+	return -1;
+}
+
+void SequentialAnimationGroup::updateEnabledAnims()
+{
+	if (enabledAnimsAreValid_)
+		return;
+
+	const int numAnims = anims_.size();
+	nextEnabled_.setSize(numAnims);
+	previousEnabled_.setSize(numAnims);
 
-	// Search the index of the last animation that is enabled
-	int lastEnabled = anims_.size() - 1;
-	for (int i = anims_.size() - 1; i >= 0; i--)
+	int previous = -1;
+	for (int i = 0; i < numAnims; i++)
 	{
+		previousEnabled_[i] = previous;
 		if (anims_[i]->enabled)
-		{
-			lastEnabled = i;
-			break;
-		}
+			previous = i;
 	}
+	lastEnabled_ = previous;
 
-	do
+	int next = numAnims;
+	for (int i = numAnims - 1; i >= 0; i--)
 	{
-		switch (loop_.mode())
-		{
-			case Loop::Mode::DISABLED:
-				playingIndex += (loop_.direction() == Loop::Direction::FORWARD) ? 1 : -1;
-				break;
-			case Loop::Mode::REWIND:
-				playingIndex += (loop_.direction() == Loop::Direction::FORWARD) ? 1 : -1;
-				if (playingIndex > lastEnabled)
+		nextEnabled_[i] = next;
+		if (anims_[i]->enabled)
+			next = i;
+	}
+	firstEnabled_ = (next < numAnims) ? next : -1;
+
+	enabledAnimsAreValid_ = true;
+}
+
+int SequentialAnimationGroup::nextPlayingIndex(int playingIndex)
+{
+	updateEnabledAnims();
+
+	// Return an invalid index if there are no enabled animations in the group
+	if (firstEnabled_ < 0)
+		return -1;
+
+	switch (loop_.mode())
+	{
+		case Loop::Mode::DISABLED:
+			playingIndex = (loop_.direction() == Loop::Direction::FORWARD) ? nextEnabled_[playingIndex] : previousEnabled_[playingIndex];
+			break;
+		case Loop::Mode::REWIND:
+			playingIndex = (loop_.direction() == Loop::Direction::FORWARD) ? nextEnabled_[playingIndex] : previousEnabled_[playingIndex];
+			if (playingIndex > lastEnabled_)
+			{
+				playingIndex = firstEnabled_;
+				// Stop all animations to get the initial state
+				stopAnimations();
+				loop_.justResetNow();
+			}
+			else if (playingIndex < firstEnabled_)
+			{
+				playingIndex = lastEnabled_;
+				// Stop all animations to get the initial state
+				stopAnimations();
+				loop_.justResetNow();
+			}
+			break;
+		case Loop::Mode::PING_PONG:
+			if (loop_.isGoingForward())
+			{
+				playingIndex = nextEnabled_[playingIndex];
+				if (playingIndex > lastEnabled_)
 				{
-					playingIndex = firstEnabled;
-					// Stop all animations to get the initial state
-					stopAnimations();
+					// Playing again the last animation but reverted
+					playingIndex = lastEnabled_;
 					loop_.justResetNow();
+					loop_.toggleForward();
 				}
-				else if (playingIndex < firstEnabled)
+			}
+			else
+			{
+				playingIndex = previousEnabled_[playingIndex];
+				if (playingIndex < firstEnabled_)
 				{
-					playingIndex = lastEnabled;
-					// Stop all animations to get the initial state
-					stopAnimations();
+					// Playing again the first animation but reverted
+					playingIndex = firstEnabled_;
 					loop_.justResetNow();
+					loop_.toggleForward();
 				}
-				break;
-			case Loop::Mode::PING_PONG:
-				if (loop_.isGoingForward())
-				{
-					playingIndex++;
-					if (playingIndex > lastEnabled)
-					{
-						// Playing again the last animation but reverted
-						playingIndex = lastEnabled;
-						loop_.justResetNow();
-						loop_.toggleForward();
-					}
-				}
-				else
-				{
-					playingIndex--;
-					if (playingIndex < firstEnabled)
-					{
-						// Playing again the first animation but reverted
-						playingIndex = firstEnabled;
-						loop_.justResetNow();
-						loop_.toggleForward();
-					}
-				}
-				break;
-		}
-	} while (playingIndex >=0 && playingIndex < anims_.size() && anims_[playingIndex]->enabled == false);
+			}
+			break;
+	}
 
 	return playingIndex;
 }
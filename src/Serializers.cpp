@@ -126,6 +126,7 @@ void serialize(LuaSerializer &ls, const Sprite &sprite)
 	serialize(ls, "flip_y", sprite.isFlippedY());
 	serialize(ls, "rgb_blending", sprite.rgbBlendingPreset());
 	serialize(ls, "alpha_blending", sprite.alphaBlendingPreset());
+	serialize(ls, "grid_cell_size", sprite.gridCellSize());
 }
 
 void serialize(LuaSerializer &ls, const Script &script)
@@ -255,6 +256,9 @@ void serialize(LuaSerializer &ls, const char *name, EasingCurve::Type type)
 		case EasingCurve::Type::CIRC:
 			serialize(ls, name, "circ");
 			break;
+		case EasingCurve::Type::KEYFRAMES:
+			serialize(ls, name, "keyframes");
+			break;
 	}
 }
 
@@ -272,6 +276,28 @@ void serialize(LuaSerializer &ls, const char *name, const EasingCurve &curve)
 	serialize(ls, "end_time", curve.end());
 	serialize(ls, "scale", curve.scale());
 	serialize(ls, "shift", curve.shift());
+	serialize(ls, "lookup_table_enabled", curve.hasLookupTable());
+
+	ls.buffer().append("keyframes =\n");
+	ls.buffer().append("{\n");
+	ls.indent();
+
+	for (const EasingCurve::Keyframe &keyframe : curve.keyframes())
+	{
+		ls.buffer().append("{\n");
+		ls.indent();
+
+		serialize(ls, "time", keyframe.time);
+		serialize(ls, "value", keyframe.value);
+		serialize(ls, "in_tangent", keyframe.inTangent);
+		serialize(ls, "out_tangent", keyframe.outTangent);
+
+		ls.unindent();
+		ls.buffer().append("},\n");
+	}
+
+	ls.unindent();
+	ls.buffer().append("},\n");
 
 	ls.unindent();
 	ls.buffer().append("},\n");
@@ -351,6 +377,14 @@ void serialize(LuaSerializer &ls, const Configuration &cfg)
 	serializeGlobal(ls, "frame_limit", cfg.frameLimit);
 	serializeGlobal(ls, "canvas_width", cfg.canvasWidth);
 	serializeGlobal(ls, "canvas_height", cfg.canvasHeight);
+	serializeGlobal(ls, "batch_sprites", cfg.batchSprites);
+	serializeGlobal(ls, "instanced_sprites", cfg.instancedSprites);
+	serializeGlobal(ls, "shader_grid_functions", cfg.shaderGridFunctions);
+	serializeGlobal(ls, "shared_script_state", cfg.sharedScriptState);
+	serializeGlobal(ls, "script_instruction_budget", cfg.scriptInstructionBudget);
+	serializeGlobal(ls, "script_generational_gc", cfg.scriptGenerationalGc);
+	serializeGlobal(ls, "script_gc_pause", cfg.scriptGcPause);
+	serializeGlobal(ls, "script_gc_step_multiplier", cfg.scriptGcStepMultiplier);
 	serializeGlobal(ls, "auto_gui_scaling", cfg.autoGuiScaling);
 	serializeGlobal(ls, "gui_scaling", cfg.guiScaling);
 	serializeGlobal(ls, "startup_project_name", cfg.startupProjectName);
@@ -514,6 +548,9 @@ void deserialize(LuaSerializer &ls, nctl::UniquePtr<Sprite> &sprite)
 		sprite->setRgbBlendingPreset(deserialize<Sprite::BlendingPreset>(ls, "blending"));
 		sprite->setAlphaBlendingPreset(deserialize<Sprite::BlendingPreset>(ls, "blending"));
 	}
+
+	if (context->version >= 8)
+		sprite->setGridCellSize(deserialize<int>(ls, "grid_cell_size"));
 }
 
 void deserialize(LuaSerializer &ls, nctl::UniquePtr<Script> &script)
@@ -614,6 +651,8 @@ EasingCurve::Type deserialize(LuaSerializer &ls, const char *name)
 		return EasingCurve::Type::EXPO;
 	else if (easingTypeString == "circ")
 		return EasingCurve::Type::CIRC;
+	else if (easingTypeString == "keyframes")
+		return EasingCurve::Type::KEYFRAMES;
 	else
 		return EasingCurve::Type::LINEAR;
 }
@@ -637,6 +676,20 @@ void deserialize(LuaSerializer &ls, const char *name, EasingCurve &curve)
 	curve.setEnd(deserialize<float>(ls, "end_time"));
 	curve.setScale(deserialize<float>(ls, "scale"));
 	curve.setShift(deserialize<float>(ls, "shift"));
+	if (context->version >= 9)
+		curve.enableLookupTable(deserialize<bool>(ls, "lookup_table_enabled"));
+	if (context->version >= 10)
+	{
+		for (Array ar(ls, "keyframes"); ar.hasNext(); ar.next())
+		{
+			EasingCurve::Keyframe keyframe;
+			keyframe.time = deserialize<float>(ls, "time");
+			keyframe.value = deserialize<float>(ls, "value");
+			keyframe.inTangent = deserialize<float>(ls, "in_tangent");
+			keyframe.outTangent = deserialize<float>(ls, "out_tangent");
+			curve.addKeyframe(keyframe);
+		}
+	}
 
 	nc::LuaUtils::pop(L);
 }
@@ -807,6 +860,22 @@ void deserialize(LuaSerializer &ls, Configuration &cfg)
 
 	if (version >= 5)
 		deserialize(ls, "pinned_directories", cfg.pinnedDirectories);
+
+	if (version >= 7)
+		cfg.batchSprites = deserializeGlobal<bool>(ls, "batch_sprites");
+	if (version >= 8)
+		cfg.instancedSprites = deserializeGlobal<bool>(ls, "instanced_sprites");
+	if (version >= 9)
+		cfg.shaderGridFunctions = deserializeGlobal<bool>(ls, "shader_grid_functions");
+	if (version >= 10)
+		cfg.sharedScriptState = deserializeGlobal<bool>(ls, "shared_script_state");
+	if (version >= 11)
+	{
+		cfg.scriptInstructionBudget = deserializeGlobal<int>(ls, "script_instruction_budget");
+		cfg.scriptGenerationalGc = deserializeGlobal<bool>(ls, "script_generational_gc");
+		cfg.scriptGcPause = deserializeGlobal<int>(ls, "script_gc_pause");
+		cfg.scriptGcStepMultiplier = deserializeGlobal<int>(ls, "script_gc_step_multiplier");
+	}
 }
 
 }
@@ -3,6 +3,9 @@
 #include "Texture.h"
 #include "RenderingResources.h"
 #include "AnimationManager.h"
+#include "SpriteManager.h"
+#include "GridAnimation.h"
+#include "GridFunction.h"
 #include "singletons.h"
 #include <ncine/Matrix4x4.h>
 #include <ncine/RenderResources.h>
@@ -12,16 +15,6 @@
 
 #include "shader_strings.h"
 
-namespace {
-
-struct VertexFormat
-{
-	GLfloat position[2];
-	GLfloat texcoords[2];
-};
-
-}
-
 ///////////////////////////////////////////////////////////
 // CONSTRUCTORS and DESTRUCTOR
 ///////////////////////////////////////////////////////////
@@ -31,12 +24,15 @@ Sprite::Sprite(Texture *texture)
       name(MaxNameLength), visible(true), x(0.0f), y(0.0f), rotation(0.0f), scaleFactor(1.0f, 1.0f),
       anchorPoint(0.0f, 0.0f), color(nc::Colorf::White), visited(false), gridAnchorPoint(0.0f, 0.0f),
       width_(0), height_(0), localMatrix_(nc::Matrix4x4f::Identity), worldMatrix_(nc::Matrix4x4f::Identity),
-      absPosition_(0.0f, 0.0f), absScaleFactor_(1.0f, 1.0f), absRotation_(0.0f), absColor_(nc::Colorf::White),
+      absPosition_(0.0f, 0.0f), absScaleFactor_(1.0f, 1.0f), absRotation_(0.0f), absColor_(nc::Colorf::White), transformDirty_(true),
       texture_(nullptr), texRect_(0, 0, 0, 0), flippingTexRect_(0, 0, 0, 0),
       flippedX_(false), flippedY_(false),
       rgbBlendingPreset_(BlendingPreset::ALPHA), alphaBlendingPreset_(BlendingPreset::ALPHA),
-      gridAnimationsCounter_(0), interleavedVertices_(0), restPositions_(0),
-      indices_(0), shortIndices_(0), parent_(nullptr), children_(4)
+      gridAnimationsCounter_(0), scriptAnimationsCounter_(0), gridCellSize_(1), gridWidth_(0), gridHeight_(0),
+      vertices_(0), restPositions_(0), texCoords_(0), restTexCoords_(0), indices_(0), shortIndices_(0),
+      verticesModified_(false), vboHoldsVertices_(false), texCoordsModified_(false), vboHoldsRestTexCoords_(false),
+      vboCapacity_(0), queuedGridAnims_(4), lastGridAnims_(4), gridInputsChanged_(false), numShaderGridFunctions_(0),
+      parent_(nullptr), children_(4)
 {
 	spriteShaderProgram_ = RenderingResources::spriteShaderProgram();
 	spriteShaderUniforms_ = nctl::makeUnique<nc::GLShaderUniforms>(spriteShaderProgram_);
@@ -49,12 +45,28 @@ Sprite::Sprite(Texture *texture)
 	meshSpriteShaderUniforms_ = nctl::makeUnique<nc::GLShaderUniforms>(meshSpriteShaderProgram_);
 	meshSpriteShaderUniforms_->setUniformsDataPointer(uniformsBuffer_);
 	meshSpriteShaderUniforms_->uniform("uTexture")->setIntValue(0);
-	meshSpriteShaderProgram_->attribute("aPosition")->setVboParameters(sizeof(VertexFormat), reinterpret_cast<void *>(offsetof(VertexFormat, position)));
-	meshSpriteShaderProgram_->attribute("aTexCoords")->setVboParameters(sizeof(VertexFormat), reinterpret_cast<void *>(offsetof(VertexFormat, texcoords)));
+	meshSpriteShaderProgram_->attribute("aPosition")->setVboParameters(sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+	// Texture coordinates are redirected to their own buffer after the vertex format is defined
+	meshSpriteShaderProgram_->attribute("aTexCoords")->setVboParameters(sizeof(TexCoords), reinterpret_cast<void *>(offsetof(TexCoords, u)));
+	meshTexCoordsLocation_ = glGetAttribLocation(meshSpriteShaderProgram_->glHandle(), "aTexCoords");
 
 	FATAL_ASSERT(UniformsBufferSize >= spriteShaderProgram_->uniformsSize());
 
+	meshSpriteGridShaderProgram_ = RenderingResources::meshSpriteGridShaderProgram();
+	meshSpriteGridShaderUniforms_ = nctl::makeUnique<nc::GLShaderUniforms>(meshSpriteGridShaderProgram_);
+	meshSpriteGridShaderUniforms_->setUniformsDataPointer(uniformsBuffer_);
+	meshSpriteGridShaderUniforms_->uniform("uTexture")->setIntValue(0);
+	meshSpriteGridShaderProgram_->attribute("aPosition")->setVboParameters(sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+	meshSpriteGridShaderProgram_->attribute("aTexCoords")->setVboParameters(sizeof(TexCoords), reinterpret_cast<void *>(offsetof(TexCoords, u)));
+	meshGridTexCoordsLocation_ = glGetAttribLocation(meshSpriteGridShaderProgram_->glHandle(), "aTexCoords");
+	// The function array is set directly after the program is in use, as it changes with every draw
+	numGridFunctionsLocation_ = glGetUniformLocation(meshSpriteGridShaderProgram_->glHandle(), "numGridFunctions");
+	gridFunctionsLocation_ = glGetUniformLocation(meshSpriteGridShaderProgram_->glHandle(), "gridFunctions");
+
+	FATAL_ASSERT(UniformsBufferSize >= meshSpriteGridShaderProgram_->uniformsSize());
+
 	vbo_ = nctl::makeUnique<nc::GLBufferObject>(GL_ARRAY_BUFFER);
+	texCoordsVbo_ = nctl::makeUnique<nc::GLBufferObject>(GL_ARRAY_BUFFER);
 	ibo_ = nctl::makeUnique<nc::GLBufferObject>(GL_ELEMENT_ARRAY_BUFFER);
 
 	setTexture(texture);
@@ -86,6 +98,7 @@ nctl::UniquePtr<Sprite> Sprite::clone() const
 	sprite->setTexRect(texRect_);
 	sprite->setRgbBlendingPreset(rgbBlendingPreset_);
 	sprite->setAlphaBlendingPreset(alphaBlendingPreset_);
+	sprite->setGridCellSize(gridCellSize_);
 
 	// Vertices and indices don't need to be copied
 
@@ -97,12 +110,31 @@ nctl::UniquePtr<Sprite> Sprite::clone() const
 	return sprite;
 }
 
-void Sprite::transform()
+bool Sprite::transform(bool parentChanged)
 {
-	localMatrix_ = nc::Matrix4x4f::translation(x, y, 0.0f);
-	localMatrix_.rotateZ(rotation);
-	localMatrix_.scale(scaleFactor.x, scaleFactor.y, 1.0f);
-	localMatrix_.translate(-anchorPoint.x, -anchorPoint.y, 0.0f);
+	// Properties are public and written from many places, changes are detected by comparing them with the last used ones
+	const bool propertiesChanged = (x != lastTransform_.x || y != lastTransform_.y || rotation != lastTransform_.rotation ||
+	                                scaleFactor != lastTransform_.scaleFactor || anchorPoint != lastTransform_.anchorPoint ||
+	                                color.r() != lastTransform_.color.r() || color.g() != lastTransform_.color.g() ||
+	                                color.b() != lastTransform_.color.b() || color.a() != lastTransform_.color.a());
+
+	if (propertiesChanged == false && parentChanged == false && transformDirty_ == false)
+		return false;
+
+	if (propertiesChanged || transformDirty_)
+	{
+		localMatrix_ = nc::Matrix4x4f::translation(x, y, 0.0f);
+		localMatrix_.rotateZ(rotation);
+		localMatrix_.scale(scaleFactor.x, scaleFactor.y, 1.0f);
+		localMatrix_.translate(-anchorPoint.x, -anchorPoint.y, 0.0f);
+
+		lastTransform_.x = x;
+		lastTransform_.y = y;
+		lastTransform_.rotation = rotation;
+		lastTransform_.scaleFactor = scaleFactor;
+		lastTransform_.anchorPoint = anchorPoint;
+		lastTransform_.color = color;
+	}
 
 	absScaleFactor_ = scaleFactor;
 	absRotation_ = rotation;
@@ -120,9 +152,12 @@ void Sprite::transform()
 		worldMatrix_ = localMatrix_;
 
 	absPosition_.set(worldMatrix_[3][0], worldMatrix_[3][1]);
+	transformDirty_ = false;
+
+	return true;
 }
 
-void Sprite::updateRender()
+nc::Vector4f Sprite::texRectScaleBias() const
 {
 	const float texWidth = static_cast<float>(texture_->width());
 	const float texHeight = static_cast<float>(texture_->height());
@@ -131,10 +166,17 @@ void Sprite::updateRender()
 	const float texScaleY = flippingTexRect_.h / texHeight;
 	const float texBiasY = (flippingTexRect_.y + 0.5f) / (texHeight + 0.5f);
 
+	return nc::Vector4f(texScaleX, texBiasX, texScaleY, texBiasY);
+}
+
+void Sprite::updateRender()
+{
+	const nc::Vector4f texRect = texRectScaleBias();
+
 	if (gridAnimationsCounter_ == 0)
 	{
 		spriteShaderUniforms_->uniform("color")->setFloatVector(absColor_.data());
-		spriteShaderUniforms_->uniform("texRect")->setFloatValue(texScaleX, texBiasX, texScaleY, texBiasY);
+		spriteShaderUniforms_->uniform("texRect")->setFloatVector(texRect.data());
 		spriteShaderUniforms_->uniform("spriteSize")->setFloatValue(width_, height_);
 		spriteShaderUniforms_->uniform("projection")->setFloatVector(RenderingResources::projectionMatrix().data());
 		spriteShaderUniforms_->uniform("modelView")->setFloatVector(worldMatrix_.data());
@@ -142,16 +184,41 @@ void Sprite::updateRender()
 	}
 	else
 	{
-		meshSpriteShaderUniforms_->uniform("color")->setFloatVector(absColor_.data());
-		meshSpriteShaderUniforms_->uniform("texRect")->setFloatValue(texScaleX, texBiasX, texScaleY, texBiasY);
-		meshSpriteShaderUniforms_->uniform("spriteSize")->setFloatValue(width_, height_);
-		meshSpriteShaderUniforms_->uniform("projection")->setFloatVector(RenderingResources::projectionMatrix().data());
-		meshSpriteShaderUniforms_->uniform("modelView")->setFloatVector(worldMatrix_.data());
-		meshSpriteShaderUniforms_->commitUniforms();
-
-		meshSpriteShaderProgram_->defineVertexFormat(vbo_.get(), ibo_.get());
-		const long int vboBytes = interleavedVertices_.size() * sizeof(Vertex);
-		vbo_->bufferData(vboBytes, interleavedVertices_.data(), GL_STATIC_DRAW);
+		nc::GLShaderProgram *shaderProgram = meshSpriteShaderProgram_;
+		nc::GLShaderUniforms *shaderUniforms = meshSpriteShaderUniforms_.get();
+		int texCoordsLocation = meshTexCoordsLocation_;
+		if (numShaderGridFunctions_ > 0)
+		{
+			shaderProgram = meshSpriteGridShaderProgram_;
+			shaderUniforms = meshSpriteGridShaderUniforms_.get();
+			texCoordsLocation = meshGridTexCoordsLocation_;
+		}
+
+		shaderUniforms->uniform("color")->setFloatVector(absColor_.data());
+		shaderUniforms->uniform("texRect")->setFloatVector(texRect.data());
+		shaderUniforms->uniform("spriteSize")->setFloatValue(width_, height_);
+		shaderUniforms->uniform("projection")->setFloatVector(RenderingResources::projectionMatrix().data());
+		shaderUniforms->uniform("modelView")->setFloatVector(worldMatrix_.data());
+		shaderUniforms->commitUniforms();
+
+		shaderProgram->defineVertexFormat(vbo_.get(), ibo_.get());
+		// The vertex array is now bound, the texture coordinates attribute can be pointed to its own buffer
+		texCoordsVbo_->bind();
+		glVertexAttribPointer(texCoordsLocation, 2, GL_FLOAT, GL_FALSE, sizeof(TexCoords), reinterpret_cast<void *>(offsetof(TexCoords, u)));
+
+		// Vertices are only uploaded when they differ from the ones already in the buffer
+		if (vboHoldsVertices_ == false)
+		{
+			uploadVertices();
+			vboHoldsVertices_ = true;
+		}
+		// Texture coordinates are usually uploaded only once, when the grid is created
+		if (texCoordsModified_ || vboHoldsRestTexCoords_ == false)
+		{
+			const long int texCoordsBytes = texCoords_.size() * sizeof(TexCoords);
+			texCoordsVbo_->bufferData(texCoordsBytes, texCoords_.data(), GL_STATIC_DRAW);
+			vboHoldsRestTexCoords_ = (texCoordsModified_ == false);
+		}
 	}
 }
 
@@ -166,7 +233,14 @@ void Sprite::render()
 	}
 	else
 	{
-		meshSpriteShaderProgram_->use();
+		if (numShaderGridFunctions_ > 0)
+		{
+			meshSpriteGridShaderProgram_->use();
+			glUniform1i(numGridFunctionsLocation_, static_cast<GLint>(numShaderGridFunctions_));
+			glUniform4fv(gridFunctionsLocation_, static_cast<GLsizei>(numShaderGridFunctions_ * 2), shaderGridFunctions_);
+		}
+		else
+			meshSpriteShaderProgram_->use();
 
 		if (shortIndices_.isEmpty() == false)
 			glDrawElements(GL_TRIANGLE_STRIP, shortIndices_.size(), GL_UNSIGNED_SHORT, nullptr);
@@ -177,9 +251,17 @@ void Sprite::render()
 
 void Sprite::resetGrid()
 {
-	ASSERT(interleavedVertices_.size() == restPositions_.size());
-	for (unsigned int i = 0; i < restPositions_.size(); i++)
-		interleavedVertices_[i] = restPositions_[i];
+	// Deferred deformations are kept, they will be reused if the grid animations do not change
+	if (defersGridAnimations() == false)
+		restoreRestPositions();
+	ASSERT(texCoords_.size() == restTexCoords_.size());
+	if (texCoordsModified_)
+	{
+		for (unsigned int i = 0; i < restTexCoords_.size(); i++)
+			texCoords_[i] = restTexCoords_[i];
+		texCoordsModified_ = false;
+	}
+	numShaderGridFunctions_ = 0;
 }
 
 void Sprite::setTexture(Texture *texture)
@@ -257,13 +339,150 @@ void Sprite::decrementGridAnimCounter()
 	FATAL_ASSERT(gridAnimationsCounter_ >= 0);
 	if (gridAnimationsCounter_ == 0)
 	{
-		interleavedVertices_.clear();
+		queuedGridAnims_.clear();
+		lastGridAnims_.clear();
+		vertices_.clear();
 		restPositions_.clear();
+		texCoords_.clear();
+		restTexCoords_.clear();
 		indices_.clear();
 		shortIndices_.clear();
 	}
 }
 
+void Sprite::incrementScriptAnimCounter()
+{
+	// Grid animations are going to be applied immediately, on top of the rest positions
+	restoreRestPositions();
+	queuedGridAnims_.clear();
+	lastGridAnims_.clear();
+	scriptAnimationsCounter_++;
+	incrementGridAnimCounter();
+}
+
+void Sprite::decrementScriptAnimCounter()
+{
+	scriptAnimationsCounter_--;
+	FATAL_ASSERT(scriptAnimationsCounter_ >= 0);
+	decrementGridAnimCounter();
+}
+
+void Sprite::queueGridAnimation(GridAnimation *gridAnimation, bool inputsChanged)
+{
+	ASSERT(gridAnimation);
+	gridInputsChanged_ = gridInputsChanged_ || inputsChanged;
+
+	for (unsigned int i = 0; i < queuedGridAnims_.size(); i++)
+	{
+		// The animation has been performed more than once since the last draw
+		if (queuedGridAnims_[i] == gridAnimation)
+			return;
+	}
+	queuedGridAnims_.pushBack(gridAnimation);
+}
+
+void Sprite::dequeueGridAnimation(GridAnimation *gridAnimation)
+{
+	for (unsigned int i = 0; i < queuedGridAnims_.size(); i++)
+	{
+		if (queuedGridAnims_[i] == gridAnimation)
+		{
+			queuedGridAnims_.removeAt(i);
+			gridInputsChanged_ = true;
+			break;
+		}
+	}
+}
+
+bool Sprite::gridNeedsUpdate() const
+{
+	if (defersGridAnimations() == false || gridAnimationsCounter_ == 0)
+		return false;
+	if (gridInputsChanged_ || queuedGridAnims_.size() != lastGridAnims_.size())
+		return true;
+
+	for (unsigned int i = 0; i < queuedGridAnims_.size(); i++)
+	{
+		if (queuedGridAnims_[i] != lastGridAnims_[i])
+			return true;
+	}
+	return false;
+}
+
+void Sprite::deformGridRows(int firstRow, int lastRow)
+{
+	ASSERT(firstRow >= 0 && lastRow <= gridHeight_ + 1);
+	const unsigned int verticesPerRow = static_cast<unsigned int>(gridWidth_ + 1);
+
+	if (verticesModified_)
+	{
+		for (unsigned int i = firstRow * verticesPerRow; i < lastRow * verticesPerRow; i++)
+			vertices_[i] = restPositions_[i];
+	}
+
+	for (unsigned int i = 0; i < queuedGridAnims_.size(); i++)
+	{
+		GridAnimation &gridAnim = *queuedGridAnims_[i];
+		if (gridAnim.function())
+			gridAnim.function()->execute(gridAnim, firstRow, lastRow);
+	}
+}
+
+void Sprite::commitGrid(bool deformed)
+{
+	if (deformed)
+	{
+		if (verticesModified_ || queuedGridAnims_.isEmpty() == false)
+			vboHoldsVertices_ = false;
+		verticesModified_ = (queuedGridAnims_.isEmpty() == false);
+	}
+
+	lastGridAnims_.clear();
+	for (unsigned int i = 0; i < queuedGridAnims_.size(); i++)
+		lastGridAnims_.pushBack(queuedGridAnims_[i]);
+	queuedGridAnims_.clear();
+	gridInputsChanged_ = false;
+}
+
+bool Sprite::usesShaderGrid() const
+{
+	// Scripts need to read the deformed vertices, so they force the CPU path
+	return (theCfg.shaderGridFunctions && scriptAnimationsCounter_ == 0);
+}
+
+bool Sprite::addShaderGridFunction(int shaderId, float value, const float params[GridFunctionShaderParams])
+{
+	if (numShaderGridFunctions_ >= MaxShaderGridFunctions)
+		return false;
+
+	float *function = &shaderGridFunctions_[numShaderGridFunctions_ * 8];
+	function[0] = static_cast<float>(shaderId);
+	function[1] = value;
+	function[2] = 0.0f;
+	function[3] = 0.0f;
+	for (unsigned int i = 0; i < GridFunctionShaderParams; i++)
+		function[4 + i] = params[i];
+	function[7] = 0.0f;
+
+	numShaderGridFunctions_++;
+	return true;
+}
+
+void Sprite::setGridCellSize(int gridCellSize)
+{
+	if (gridCellSize < 1)
+		gridCellSize = 1;
+	else if (gridCellSize > MaxGridCellSize)
+		gridCellSize = MaxGridCellSize;
+
+	if (gridCellSize_ != gridCellSize)
+	{
+		gridCellSize_ = gridCellSize;
+		if (gridAnimationsCounter_ > 0)
+			initGrid(width_, height_);
+	}
+}
+
 void Sprite::setParent(Sprite *parent)
 {
 	if (parent == this || parent == parent_)
@@ -274,6 +493,10 @@ void Sprite::setParent(Sprite *parent)
 	if (parent)
 		parent->addChild(this);
 	parent_ = parent;
+
+	transformDirty_ = true;
+	if (theSpriteMgr)
+		theSpriteMgr->invalidateSpritesWithoutParent();
 }
 
 void Sprite::setAbsPosition(float xx, float yy)
@@ -315,24 +538,36 @@ void Sprite::setSize(int width, int height)
 
 void Sprite::initGrid(int width, int height)
 {
-	const unsigned int verticesCapacity = (width + 1) * (height + 1);
-	if (interleavedVertices_.capacity() < verticesCapacity)
+	gridWidth_ = (width + gridCellSize_ - 1) / gridCellSize_;
+	gridHeight_ = (height + gridCellSize_ - 1) / gridCellSize_;
+
+	const unsigned int verticesCapacity = (gridWidth_ + 1) * (gridHeight_ + 1);
+	if (vertices_.capacity() < verticesCapacity)
 	{
-		interleavedVertices_.setCapacity(verticesCapacity);
+		vertices_.setCapacity(verticesCapacity);
 		restPositions_.setCapacity(verticesCapacity);
-		const long int vboBytes = interleavedVertices_.size() * sizeof(Vertex);
-		vbo_->bufferData(vboBytes, nullptr, GL_STATIC_DRAW);
+		texCoords_.setCapacity(verticesCapacity);
+		restTexCoords_.setCapacity(verticesCapacity);
+		vboCapacity_ = verticesCapacity * sizeof(Vertex);
+		vbo_->bufferData(vboCapacity_, nullptr, GL_STREAM_DRAW);
+		texCoordsVbo_->bufferData(verticesCapacity * sizeof(TexCoords), nullptr, GL_STATIC_DRAW);
 	}
 
 	// Upper bound for number of indices
-	const unsigned int indicesCapacity = (width + 2) * height * 2;
+	const unsigned int indicesCapacity = (gridWidth_ + 2) * gridHeight_ * 2;
 	if (indices_.capacity() < indicesCapacity)
 		indices_.setCapacity(indicesCapacity);
 
 	resetVertices();
-	ASSERT(interleavedVertices_.capacity() >= verticesCapacity);
+	verticesModified_ = false;
+	vboHoldsVertices_ = false;
+	texCoordsModified_ = false;
+	vboHoldsRestTexCoords_ = false;
+	ASSERT(vertices_.capacity() >= verticesCapacity);
 	resetIndices();
 	ASSERT(indices_.capacity() >= indicesCapacity);
+	// The deformation needs to be computed again on the new grid
+	lastGridAnims_.clear();
 
 	const unsigned int indicesSize = indices_.size();
 	const long int iboBytes = (indicesSize < 65536)
@@ -351,31 +586,61 @@ void Sprite::initGrid(int width, int height)
 		ibo_->bufferData(iboBytes, indices_.data(), GL_STATIC_DRAW);
 }
 
+void Sprite::restoreRestPositions()
+{
+	ASSERT(vertices_.size() == restPositions_.size());
+	if (verticesModified_)
+	{
+		for (unsigned int i = 0; i < restPositions_.size(); i++)
+			vertices_[i] = restPositions_[i];
+		verticesModified_ = false;
+		vboHoldsVertices_ = false;
+	}
+}
+
+void Sprite::uploadVertices()
+{
+	// Orphaned like in `SpriteBatcher::uploadVbo()`, the capacity only grows when the grid gets more vertices
+	const long int vboBytes = vertices_.size() * sizeof(Vertex);
+	if (vboCapacity_ < vboBytes)
+		vboCapacity_ = vboBytes;
+	vbo_->bufferData(vboCapacity_, nullptr, GL_STREAM_DRAW);
+	vbo_->bufferSubData(0, vboBytes, vertices_.data());
+}
+
 void Sprite::resetVertices()
 {
-	interleavedVertices_.clear();
+	vertices_.clear();
 	restPositions_.clear();
+	texCoords_.clear();
+	restTexCoords_.clear();
 	const float deltaX = 1.0f / static_cast<float>(width_);
 	const float deltaY = 1.0f / static_cast<float>(height_);
 
-	for (int y = 0; y < height_ + 1; y++)
+	for (int row = 0; row < gridHeight_ + 1; row++)
 	{
-		for (int x = 0; x < width_ + 1; x++)
+		const float y = static_cast<float>(gridTexelY(row));
+		for (int column = 0; column < gridWidth_ + 1; column++)
 		{
+			const float x = static_cast<float>(gridTexelX(column));
 			Vertex v;
-			v.x = -0.5f + static_cast<float>(x) * deltaX;
-			v.y = -0.5f + static_cast<float>(y) * deltaY;
-			v.u = static_cast<float>(x) * deltaX;
-			v.v = static_cast<float>(y) * deltaY;
-			interleavedVertices_.pushBack(v);
+			v.x = -0.5f + x * deltaX;
+			v.y = -0.5f + y * deltaY;
+			vertices_.pushBack(v);
 			restPositions_.pushBack(v);
+
+			TexCoords t;
+			t.u = x * deltaX;
+			t.v = y * deltaY;
+			texCoords_.pushBack(t);
+			restTexCoords_.pushBack(t);
 		}
 	}
 
 #if 0
 	nctl::String verticesString(1024 * 10);
-	for (unsigned int i = 0; i < interleavedVertices_.size(); i++)
-		verticesString.formatAppend("#%u <%.2f, %.2f>\n", i, interleavedVertices_[i].x, interleavedVertices_[i].y);
+	for (unsigned int i = 0; i < vertices_.size(); i++)
+		verticesString.formatAppend("#%u <%.2f, %.2f>\n", i, vertices_[i].x, vertices_[i].y);
 	LOGE_X("Vertices:\n%s", verticesString.data());
 #endif
 }
@@ -383,10 +648,10 @@ void Sprite::resetVertices()
 void Sprite::resetIndices()
 {
 	indices_.clear();
-	const unsigned int gridWidth = static_cast<unsigned int>(width_ + 1);
+	const unsigned int gridWidth = static_cast<unsigned int>(gridWidth_ + 1);
 
 	unsigned int vertexIndex = gridWidth;
-	for (unsigned int i = 0; i < height_; i++)
+	for (unsigned int i = 0; i < static_cast<unsigned int>(gridHeight_); i++)
 	{
 		for (unsigned int j = 0; j < gridWidth; j++)
 		{
@@ -0,0 +1,222 @@
+#include <stddef.h> // for offsetof()
+#include "SpriteBatcher.h"
+#include "Texture.h"
+#include "RenderingResources.h"
+#include <ncine/GLBufferObject.h>
+#include <ncine/GLShaderProgram.h>
+#include <ncine/GLShaderUniforms.h>
+
+namespace {
+
+const char *InstanceAttributeNames[] = { "aTransform", "aPositionSize", "aTexRect", "aColor" };
+
+}
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+SpriteBatcher::SpriteBatcher()
+    : instancing_(true), texture_(nullptr), rgbBlendingPreset_(Sprite::BlendingPreset::ALPHA),
+      alphaBlendingPreset_(Sprite::BlendingPreset::ALPHA), numSprites_(0),
+      vertices_(64 * VerticesPerSprite), instances_(64), vboCapacity_(0)
+{
+	shaderProgram_ = RenderingResources::batchedSpritesShaderProgram();
+	shaderUniforms_ = nctl::makeUnique<nc::GLShaderUniforms>(shaderProgram_);
+	shaderUniforms_->setUniformsDataPointer(uniformsBuffer_);
+	shaderUniforms_->uniform("uTexture")->setIntValue(0);
+	shaderProgram_->attribute("aPosition")->setVboParameters(sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+	shaderProgram_->attribute("aTexCoords")->setVboParameters(sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, u)));
+	shaderProgram_->attribute("aColor")->setVboParameters(sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, r)));
+
+	FATAL_ASSERT(UniformsBufferSize >= shaderProgram_->uniformsSize());
+
+	instancedShaderProgram_ = RenderingResources::instancedSpritesShaderProgram();
+	instancedShaderUniforms_ = nctl::makeUnique<nc::GLShaderUniforms>(instancedShaderProgram_);
+	instancedShaderUniforms_->setUniformsDataPointer(instancedUniformsBuffer_);
+	instancedShaderUniforms_->uniform("uTexture")->setIntValue(0);
+	instancedShaderProgram_->attribute("aTransform")->setVboParameters(sizeof(Instance), reinterpret_cast<void *>(offsetof(Instance, transform)));
+	instancedShaderProgram_->attribute("aPositionSize")->setVboParameters(sizeof(Instance), reinterpret_cast<void *>(offsetof(Instance, positionSize)));
+	instancedShaderProgram_->attribute("aTexRect")->setVboParameters(sizeof(Instance), reinterpret_cast<void *>(offsetof(Instance, texRect)));
+	instancedShaderProgram_->attribute("aColor")->setVboParameters(sizeof(Instance), reinterpret_cast<void *>(offsetof(Instance, color)));
+	for (unsigned int i = 0; i < NumInstanceAttributes; i++)
+		instanceAttributeLocations_[i] = glGetAttribLocation(instancedShaderProgram_->glHandle(), InstanceAttributeNames[i]);
+
+	FATAL_ASSERT(UniformsBufferSize >= instancedShaderProgram_->uniformsSize());
+
+	vbo_ = nctl::makeUnique<nc::GLBufferObject>(GL_ARRAY_BUFFER);
+}
+
+SpriteBatcher::~SpriteBatcher() = default;
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void SpriteBatcher::setInstancing(bool instancing)
+{
+	if (numSprites_ == 0)
+		instancing_ = instancing;
+}
+
+bool SpriteBatcher::canAppend(const Sprite &sprite) const
+{
+	if (numSprites_ == 0)
+		return true;
+
+	return (&sprite.texture() == texture_ &&
+	        sprite.rgbBlendingPreset() == rgbBlendingPreset_ &&
+	        sprite.alphaBlendingPreset() == alphaBlendingPreset_);
+}
+
+void SpriteBatcher::append(Sprite &sprite)
+{
+	ASSERT(canAppend(sprite));
+	ASSERT(sprite.isMeshSprite() == false);
+
+	if (numSprites_ == 0)
+	{
+		texture_ = &sprite.texture();
+		rgbBlendingPreset_ = sprite.rgbBlendingPreset();
+		alphaBlendingPreset_ = sprite.alphaBlendingPreset();
+	}
+
+	if (instancing_)
+		appendInstance(sprite);
+	else
+		appendVertices(sprite);
+
+	numSprites_++;
+}
+
+void SpriteBatcher::flush()
+{
+	if (numSprites_ == 0)
+		return;
+
+	texture_->bind();
+	if (instancing_)
+		drawInstances();
+	else
+		drawVertices();
+
+	vertices_.clear();
+	instances_.clear();
+	numSprites_ = 0;
+	texture_ = nullptr;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void SpriteBatcher::appendVertices(const Sprite &sprite)
+{
+	const nc::Matrix4x4f &world = sprite.worldMatrix();
+	const nc::Vector4f texRect = sprite.texRectScaleBias();
+	const nc::Colorf &color = sprite.absColor();
+	const float width = static_cast<float>(sprite.width());
+	const float height = static_cast<float>(sprite.height());
+
+	// Corners in the same order as the triangle strip in `sprite_vs`
+	Vertex corners[4];
+	const float cornerX[4] = { 0.5f, 0.5f, -0.5f, -0.5f };
+	const float cornerY[4] = { -0.5f, 0.5f, -0.5f, 0.5f };
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		const float localX = cornerX[i] * width;
+		const float localY = cornerY[i] * height;
+
+		Vertex &v = corners[i];
+		v.x = world[0].x * localX + world[1].x * localY + world[3].x;
+		v.y = world[0].y * localX + world[1].y * localY + world[3].y;
+		v.u = (cornerX[i] + 0.5f) * texRect.x + texRect.y;
+		v.v = (cornerY[i] + 0.5f) * texRect.z + texRect.w;
+		v.r = color.r();
+		v.g = color.g();
+		v.b = color.b();
+		v.a = color.a();
+	}
+
+	// Two triangles per sprite, without an index buffer
+	vertices_.pushBack(corners[0]);
+	vertices_.pushBack(corners[1]);
+	vertices_.pushBack(corners[2]);
+	vertices_.pushBack(corners[2]);
+	vertices_.pushBack(corners[1]);
+	vertices_.pushBack(corners[3]);
+}
+
+void SpriteBatcher::appendInstance(const Sprite &sprite)
+{
+	const nc::Matrix4x4f &world = sprite.worldMatrix();
+	const nc::Vector4f texRect = sprite.texRectScaleBias();
+	const nc::Colorf &color = sprite.absColor();
+
+	// Only the 2D affine part of the world matrix is needed
+	Instance instance;
+	instance.transform[0] = world[0].x;
+	instance.transform[1] = world[0].y;
+	instance.transform[2] = world[1].x;
+	instance.transform[3] = world[1].y;
+	instance.positionSize[0] = world[3].x;
+	instance.positionSize[1] = world[3].y;
+	instance.positionSize[2] = static_cast<float>(sprite.width());
+	instance.positionSize[3] = static_cast<float>(sprite.height());
+	instance.texRect[0] = texRect.x;
+	instance.texRect[1] = texRect.y;
+	instance.texRect[2] = texRect.z;
+	instance.texRect[3] = texRect.w;
+	instance.color[0] = color.r();
+	instance.color[1] = color.g();
+	instance.color[2] = color.b();
+	instance.color[3] = color.a();
+
+	instances_.pushBack(instance);
+}
+
+void SpriteBatcher::uploadVbo(const void *data, long int bytes)
+{
+	// Orphaning the previous storage avoids waiting for the draw calls that are still using it
+	if (vboCapacity_ < bytes)
+		vboCapacity_ = bytes;
+	vbo_->bufferData(vboCapacity_, nullptr, GL_STREAM_DRAW);
+	vbo_->bufferSubData(0, bytes, data);
+}
+
+void SpriteBatcher::drawVertices()
+{
+	shaderUniforms_->uniform("projection")->setFloatVector(RenderingResources::projectionMatrix().data());
+	shaderUniforms_->commitUniforms();
+
+	uploadVbo(vertices_.data(), vertices_.size() * sizeof(Vertex));
+	shaderProgram_->defineVertexFormat(vbo_.get(), nullptr);
+
+	shaderProgram_->use();
+	glDrawArrays(GL_TRIANGLES, 0, vertices_.size());
+}
+
+void SpriteBatcher::drawInstances()
+{
+	instancedShaderUniforms_->uniform("projection")->setFloatVector(RenderingResources::projectionMatrix().data());
+	instancedShaderUniforms_->commitUniforms();
+
+	uploadVbo(instances_.data(), instances_.size() * sizeof(Instance));
+	instancedShaderProgram_->defineVertexFormat(vbo_.get(), nullptr);
+
+	// The vertex format is shared with the other paths, divisors are only enabled for this draw
+	for (unsigned int i = 0; i < NumInstanceAttributes; i++)
+	{
+		if (instanceAttributeLocations_[i] >= 0)
+			glVertexAttribDivisor(static_cast<GLuint>(instanceAttributeLocations_[i]), 1);
+	}
+
+	instancedShaderProgram_->use();
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances_.size());
+
+	for (unsigned int i = 0; i < NumInstanceAttributes; i++)
+	{
+		if (instanceAttributeLocations_[i] >= 0)
+			glVertexAttribDivisor(static_cast<GLuint>(instanceAttributeLocations_[i]), 0);
+	}
+}
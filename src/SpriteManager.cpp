@@ -1,10 +1,31 @@
 #include "SpriteManager.h"
 #include "Texture.h"
 #include "Sprite.h"
+#include "SpriteBatcher.h"
+#include "singletons.h"
 #include <ncine/GLBlending.h>
+#include <ncine/ServiceLocator.h>
 
 namespace {
 
+/// Grids with fewer vertices than this in total are deformed on the main thread
+const unsigned int MinParallelGridVertices = 16384;
+/// Minimum number of vertices deformed by a single job
+const unsigned int MinJobGridVertices = 4096;
+
+struct GridRowsJobData
+{
+	Sprite *sprite;
+	int firstRow;
+	int lastRow;
+};
+
+void deformGridRowsJob(nc::JobId /*job*/, const void *data)
+{
+	const GridRowsJobData *jobData = static_cast<const GridRowsJobData *>(data);
+	jobData->sprite->deformGridRows(jobData->firstRow, jobData->lastRow);
+}
+
 void setBlendingFactors(Sprite::BlendingPreset blendingPreset, GLenum &sfactor, GLenum &dfactor)
 {
 	switch (blendingPreset)
@@ -67,11 +88,15 @@ void recursiveLinearizeSprites(SpriteGroup &group, nctl::Array<Sprite *> &sprite
 ///////////////////////////////////////////////////////////
 
 SpriteManager::SpriteManager()
-    : textures_(4), root_(nctl::makeUnique<SpriteGroup>("Root")), spritesWithoutParent_(4), spritesArray_(4)
+    : textures_(4), root_(nctl::makeUnique<SpriteGroup>("Root")), spritesWithoutParent_(4),
+      spritesWithoutParentAreValid_(false), spritesArray_(4),
+      batcher_(nctl::makeUnique<SpriteBatcher>()), gridSprites_(4), gridJobs_(16)
 {
 	nc::GLBlending::enable();
 }
 
+SpriteManager::~SpriteManager() = default;
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
@@ -91,22 +116,31 @@ void SpriteManager::updateSpritesArray()
 	spritesArray_.clear();
 	unsigned int spriteId = 0;
 	recursiveLinearizeSprites(*root_, spritesArray_, spriteId);
+	spritesWithoutParentAreValid_ = false;
 }
 
 void SpriteManager::update()
 {
-	spritesWithoutParent_.clear();
-	for (unsigned int i = 0; i < spritesArray_.size(); i++)
+	if (spritesWithoutParentAreValid_ == false)
 	{
-		if (spritesArray_[i]->parent() == nullptr)
-			spritesWithoutParent_.pushBack(spritesArray_[i]);
+		spritesWithoutParent_.clear();
+		for (unsigned int i = 0; i < spritesArray_.size(); i++)
+		{
+			if (spritesArray_[i]->parent() == nullptr)
+				spritesWithoutParent_.pushBack(spritesArray_[i]);
+		}
+		spritesWithoutParentAreValid_ = true;
 	}
 
 	for (unsigned int i = 0; i < spritesWithoutParent_.size(); i++)
-		transform(spritesWithoutParent_[i]);
+		transform(spritesWithoutParent_[i], false);
 
+	updateGrids();
+
+	batcher_->setInstancing(theCfg.instancedSprites);
 	for (unsigned int i = 0; i < spritesArray_.size(); i++)
 		draw(spritesArray_[i]);
+	flushBatch();
 }
 
 int SpriteManager::textureIndex(const Texture *texture) const
@@ -161,6 +195,8 @@ void SpriteManager::clear()
 {
 	root_->children().clear();
 	spritesArray_.clear();
+	spritesWithoutParent_.clear();
+	spritesWithoutParentAreValid_ = false;
 	textures_.clear();
 }
 
@@ -168,12 +204,67 @@ void SpriteManager::clear()
 // PRIVATE FUNCTIONS
 ///////////////////////////////////////////////////////////
 
-void SpriteManager::transform(Sprite *sprite)
+void SpriteManager::transform(Sprite *sprite, bool parentChanged)
 {
-	sprite->transform();
+	// Children of a changed sprite need to be transformed again, even if their properties are the same
+	const bool changed = sprite->transform(parentChanged);
 
 	for (unsigned int i = 0; i < sprite->children().size(); i++)
-		transform(sprite->children()[i]);
+		transform(sprite->children()[i], changed);
+}
+
+void SpriteManager::updateGrids()
+{
+	gridSprites_.clear();
+	unsigned int numGridVertices = 0;
+	for (unsigned int i = 0; i < spritesArray_.size(); i++)
+	{
+		Sprite *sprite = spritesArray_[i];
+		if (sprite->visible == false || sprite->isMeshSprite() == false)
+			continue;
+
+		if (sprite->gridNeedsUpdate())
+		{
+			gridSprites_.pushBack(sprite);
+			numGridVertices += sprite->vertices().size();
+		}
+		else
+			sprite->commitGrid(false);
+	}
+
+	nc::IJobSystem &jobSystem = nc::theServiceLocator().jobSystem();
+	if (jobSystem.numThreads() > 1 && numGridVertices >= MinParallelGridVertices)
+	{
+		// Every job deforms a block of rows, large grids are split among more jobs
+		gridJobs_.clear();
+		for (unsigned int i = 0; i < gridSprites_.size(); i++)
+		{
+			Sprite *sprite = gridSprites_[i];
+			const int numRows = sprite->gridHeight() + 1;
+			const unsigned int verticesPerRow = static_cast<unsigned int>(sprite->gridWidth() + 1);
+			const int rowsPerJob = static_cast<int>((MinJobGridVertices + verticesPerRow - 1) / verticesPerRow);
+
+			for (int firstRow = 0; firstRow < numRows; firstRow += rowsPerJob)
+			{
+				const GridRowsJobData jobData = { sprite, firstRow, (firstRow + rowsPerJob < numRows) ? firstRow + rowsPerJob : numRows };
+				const nc::JobId jobId = jobSystem.createJob(deformGridRowsJob, &jobData, sizeof(GridRowsJobData));
+				jobSystem.run(jobId);
+				gridJobs_.pushBack(jobId);
+			}
+		}
+
+		// All the grids need to be deformed before drawing
+		for (unsigned int i = 0; i < gridJobs_.size(); i++)
+			jobSystem.wait(gridJobs_[i]);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < gridSprites_.size(); i++)
+			gridSprites_[i]->deformGridRows(0, gridSprites_[i]->gridHeight() + 1);
+	}
+
+	for (unsigned int i = 0; i < gridSprites_.size(); i++)
+		gridSprites_[i]->commitGrid(true);
 }
 
 void SpriteManager::draw(Sprite *sprite)
@@ -181,8 +272,28 @@ void SpriteManager::draw(Sprite *sprite)
 	if (sprite->visible == false)
 		return;
 
+	if (theCfg.batchSprites && sprite->isMeshSprite() == false)
+	{
+		if (batcher_->canAppend(*sprite) == false)
+			flushBatch();
+		batcher_->append(*sprite);
+		return;
+	}
+
+	// Sprites are drawn in order, the pending batch goes first
+	flushBatch();
+
 	sprite->updateRender();
 	setBlendingFactors(sprite->rgbBlendingPreset(), sprite->alphaBlendingPreset());
 	sprite->render();
 	sprite->resetGrid();
 }
+
+void SpriteManager::flushBatch()
+{
+	if (batcher_->isEmpty())
+		return;
+
+	setBlendingFactors(batcher_->rgbBlendingPreset(), batcher_->alphaBlendingPreset());
+	batcher_->flush();
+}
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <ncine/imgui_internal.h>
 #include <ncine/FileSystem.h>
 
@@ -21,7 +22,7 @@
 namespace {
 
 // clang-format off
-const char *easingCurveTypes[] = { "Linear", "Quadratic", "Cubic", "Quartic", "Quintic", "Sine", "Exponential", "Circular" };
+const char *easingCurveTypes[] = { "Linear", "Quadratic", "Cubic", "Quartic", "Quintic", "Sine", "Exponential", "Circular", "Keyframes" };
 const char *loopDirections[] = { "Forward", "Backward" };
 const char *loopModes[] = { "Disabled", "Rewind", "Ping Pong" };
 // clang-format on
@@ -37,7 +38,7 @@ int plotValueIndex = 0;
 ///////////////////////////////////////////////////////////
 
 AnimationWindow::AnimationWindow(UserInterface &ui)
-    : ui_(ui)
+    : ui_(ui), keyframesCurve_(nullptr), nextKeyframeId_(0)
 {
 }
 
@@ -101,7 +102,8 @@ void AnimationWindow::create()
 void AnimationWindow::createDelayAnimationGui(IAnimation &anim)
 {
 	float delay = anim.delay();
-	ImGui::SliderFloat("Delay", &delay, 0.0f, 10.0f, "%.3fs");
+	if (ImGui::SliderFloat("Delay", &delay, 0.0f, 10.0f, "%.3fs"))
+		ui_.invalidateFrames();
 	if (delay < 0.0f)
 		delay = 0.0f;
 	anim.setDelay(delay);
@@ -113,17 +115,17 @@ void AnimationWindow::createDelayAnimationGui(IAnimation &anim)
 void AnimationWindow::createLoopAnimationGui(LoopComponent &loop)
 {
 	int currentLoopDirection = static_cast<int>(loop.direction());
-	ImGui::Combo("Direction", &currentLoopDirection, loopDirections, IM_COUNTOF(loopDirections));
+	bool edited = ImGui::Combo("Direction", &currentLoopDirection, loopDirections, IM_COUNTOF(loopDirections));
 	loop.setDirection(static_cast<Loop::Direction>(currentLoopDirection));
 
 	int currentLoopMode = static_cast<int>(loop.mode());
-	ImGui::Combo("Loop Mode", &currentLoopMode, loopModes, IM_COUNTOF(loopModes));
+	edited |= ImGui::Combo("Loop Mode", &currentLoopMode, loopModes, IM_COUNTOF(loopModes));
 	loop.setMode(static_cast<Loop::Mode>(currentLoopMode));
 
 	if (loop.mode() != Loop::Mode::DISABLED)
 	{
 		float loopDelay = loop.delay();
-		ImGui::SliderFloat("Loop Delay", &loopDelay, 0.0f, 10.0f, "%.3fs");
+		edited |= ImGui::SliderFloat("Loop Delay", &loopDelay, 0.0f, 10.0f, "%.3fs");
 		if (loopDelay < 0.0f)
 			loopDelay = 0.0f;
 		loop.setDelay(loopDelay);
@@ -131,6 +133,9 @@ void AnimationWindow::createLoopAnimationGui(LoopComponent &loop)
 		if (loopDelay > 0.0f)
 			ImGui::ProgressBar(loop.currentDelay() / loopDelay, ImVec2(0.0f, 0.0f), ui::auxString.data());
 	}
+
+	if (edited)
+		ui_.invalidateFrames();
 }
 
 void AnimationWindow::createOverrideSpriteGui(AnimationGroup &animGroup)
@@ -188,7 +193,10 @@ void AnimationWindow::createOverrideSpriteGui(AnimationGroup &animGroup)
 
 		ImGui::SameLine();
 		if (ImGui::Button(Labels::Apply))
+		{
 			theAnimMgr->overrideSprite(animGroup, animSprite);
+			ui_.invalidateFrames();
+		}
 	}
 }
 
@@ -197,37 +205,63 @@ void AnimationWindow::createCurveAnimationGui(CurveAnimation &anim, const CurveA
 	createDelayAnimationGui(anim);
 
 	int currentComboCurveType = static_cast<int>(anim.curve().type());
-	ImGui::Combo("Easing Curve", &currentComboCurveType, easingCurveTypes, IM_COUNTOF(easingCurveTypes));
+	bool edited = ImGui::Combo("Easing Curve", &currentComboCurveType, easingCurveTypes, IM_COUNTOF(easingCurveTypes));
 	anim.curve().setType(static_cast<EasingCurve::Type>(currentComboCurveType));
+	if (anim.curve().type() == EasingCurve::Type::KEYFRAMES)
+		createKeyframesGui(anim.curve());
+	else
+	{
+		ImGui::SameLine();
+		edited |= ImGui::Checkbox("Table", &anim.curve().hasLookupTable());
+		if (ImGui::IsItemHovered())
+		{
+			// The error is scaled like the curve value
+			const float maxError = EasingCurve::lookupTableMaxError(anim.curve().type()) * fabsf(anim.curve().scale());
+			ImGui::SetTooltip("Interpolates %u precomputed samples, max error %.2e", EasingCurve::LookupTableSize, maxError);
+		}
+	}
 
 	createLoopAnimationGui(anim.curve().loop());
 
-	ImGui::SliderFloat("Shift", &anim.curve().shift(), limits.minShift, limits.maxShift);
+	edited |= ImGui::SliderFloat("Shift", &anim.curve().shift(), limits.minShift, limits.maxShift);
 	ImGui::SameLine();
 	ui::auxString.format("%s##Shift", Labels::Reset);
 	if (ImGui::Button(ui::auxString.data()))
+	{
 		anim.curve().shift() = 0.0f;
-	ImGui::SliderFloat("Scale", &anim.curve().scale(), limits.minScale, limits.maxScale);
+		edited = true;
+	}
+	edited |= ImGui::SliderFloat("Scale", &anim.curve().scale(), limits.minScale, limits.maxScale);
 	ImGui::SameLine();
 	ui::auxString.format("%s##Scale", Labels::Reset);
 	if (ImGui::Button(ui::auxString.data()))
+	{
 		anim.curve().scale() = 1.0f;
+		edited = true;
+	}
 
 	ImGui::Separator();
-	ImGui::SliderFloat("Speed", &anim.speed(), 0.0f, 5.0f);
+	edited |= ImGui::SliderFloat("Speed", &anim.speed(), 0.0f, 5.0f);
 	ImGui::SameLine();
 	ui::auxString.format("%s##Speed", Labels::Reset);
 	if (ImGui::Button(ui::auxString.data()))
+	{
 		anim.speed() = 1.0f;
+		edited = true;
+	}
 
-	ImGui::SliderFloat("Initial", &anim.curve().initialValue(), 0.0f, 1.0f);
+	edited |= ImGui::SliderFloat("Initial", &anim.curve().initialValue(), 0.0f, 1.0f);
 	ImGui::SameLine();
-	ImGui::Checkbox("##InitialEnabled", &anim.curve().hasInitialValue());
+	edited |= ImGui::Checkbox("##InitialEnabled", &anim.curve().hasInitialValue());
 
-	ImGui::SliderFloat("Start", &anim.curve().start(), 0.0f, 1.0f);
-	ImGui::SliderFloat("End", &anim.curve().end(), 0.0f, 1.0f);
+	edited |= ImGui::SliderFloat("Start", &anim.curve().start(), 0.0f, 1.0f);
+	edited |= ImGui::SliderFloat("End", &anim.curve().end(), 0.0f, 1.0f);
+	// The time is reset when the tree is evaluated, it does not change the rendered frames
 	ImGui::SliderFloat("Time", &anim.curve().time(), anim.curve().start(), anim.curve().end());
 
+	if (edited)
+		ui_.invalidateFrames();
+
 	if (anim.curve().start() > anim.curve().end() ||
 	    anim.curve().end() < anim.curve().start())
 	{
@@ -274,6 +308,77 @@ void AnimationWindow::createCurveAnimationGui(CurveAnimation &anim, const CurveA
 	}
 }
 
+void AnimationWindow::createKeyframesGui(EasingCurve &curve)
+{
+	if (keyframesCurve_ != &curve || keyframeIds_.size() != curve.keyframes().size())
+	{
+		keyframesCurve_ = &curve;
+		keyframeIds_.clear();
+		for (unsigned int i = 0; i < curve.keyframes().size(); i++)
+			keyframeIds_.pushBack(nextKeyframeId_++);
+	}
+
+	// The edit is applied after all the rows are shown, as it can sort the keyframes again
+	int removedIndex = -1;
+	int changedIndex = -1;
+	EasingCurve::Keyframe changedKeyframe;
+	for (unsigned int i = 0; i < curve.keyframes().size(); i++)
+	{
+		EasingCurve::Keyframe keyframe = curve.keyframes()[i];
+		// A row keeps its ID when the keyframe moves, so that a dragged time slider stays active
+		ImGui::PushID(keyframeIds_[i]);
+
+		ImGui::Text("Keyframe #%u", i);
+		ImGui::SameLine();
+		if (ImGui::Button(Labels::Remove))
+			removedIndex = static_cast<int>(i);
+
+		bool changed = ImGui::SliderFloat("Time", &keyframe.time, curve.start(), curve.end());
+		// Values outside of the unit range make the curve overshoot
+		changed |= ImGui::DragFloat("Value", &keyframe.value, 0.01f);
+		changed |= ImGui::SliderFloat("In Tangent", &keyframe.inTangent, -10.0f, 10.0f);
+		changed |= ImGui::SliderFloat("Out Tangent", &keyframe.outTangent, -10.0f, 10.0f);
+		ImGui::PopID();
+
+		if (changed)
+		{
+			changedIndex = static_cast<int>(i);
+			changedKeyframe = keyframe;
+		}
+	}
+
+	if (removedIndex >= 0)
+	{
+		curve.removeKeyframe(removedIndex);
+		keyframeIds_.removeAt(removedIndex);
+		ui_.invalidateFrames();
+	}
+	else if (changedIndex >= 0)
+	{
+		const unsigned int newIndex = curve.setKeyframe(changedIndex, changedKeyframe);
+		if (newIndex != static_cast<unsigned int>(changedIndex))
+		{
+			const int keyframeId = keyframeIds_[changedIndex];
+			keyframeIds_.removeAt(changedIndex);
+			keyframeIds_.insertAt(newIndex, keyframeId);
+		}
+		ui_.invalidateFrames();
+	}
+
+	if (ImGui::Button(Labels::Add))
+	{
+		// A new keyframe is added at the current time, on the linear curve
+		EasingCurve::Keyframe keyframe;
+		keyframe.time = curve.time();
+		keyframe.value = curve.time();
+		keyframe.inTangent = 1.0f;
+		keyframe.outTangent = 1.0f;
+		const unsigned int index = curve.addKeyframe(keyframe);
+		keyframeIds_.insertAt(index, nextKeyframeId_++);
+		ui_.invalidateFrames();
+	}
+}
+
 bool createCustomSpritesCombo(SpriteAnimation &anim)
 {
 	Sprite *animSprite = anim.sprite();
@@ -347,6 +452,8 @@ void AnimationWindow::createPropertyAnimationGui(PropertyAnimation &anim)
 	if (theSpriteMgr->sprites().isEmpty() == false)
 	{
 		const bool comboReturnValue = createCustomSpritesCombo(anim);
+		if (comboReturnValue)
+			ui_.invalidateFrames();
 		if (comboReturnValue && anim.sprite() != nullptr)
 			ui_.selectedSpriteEntry_ = anim.sprite();
 
@@ -357,7 +464,10 @@ void AnimationWindow::createPropertyAnimationGui(PropertyAnimation &anim)
 
 		bool setCurveShift = false;
 		if (ImGui::Combo("Property", &currentComboProperty, Properties::Strings, IM_COUNTOF(Properties::Strings)))
+		{
 			setCurveShift = true;
+			ui_.invalidateFrames();
+		}
 		anim.setProperty(static_cast<Properties::Types>(currentComboProperty));
 		switch (currentComboProperty)
 		{
@@ -435,7 +545,8 @@ void AnimationWindow::createPropertyAnimationGui(PropertyAnimation &anim)
 
 		ImGui::SameLine();
 		bool isLocked = anim.isLocked();
-		ImGui::Checkbox(Labels::Locked, &isLocked);
+		if (ImGui::Checkbox(Labels::Locked, &isLocked))
+			ui_.invalidateFrames();
 		anim.setLocked(isLocked);
 	}
 	else
@@ -459,6 +570,8 @@ void AnimationWindow::createGridAnimationGui(GridAnimation &anim)
 	if (theSpriteMgr->sprites().isEmpty() == false)
 	{
 		const bool comboReturnValue = createCustomSpritesCombo(anim);
+		if (comboReturnValue)
+			ui_.invalidateFrames();
 		if (comboReturnValue && anim.sprite() != nullptr)
 			ui_.selectedSpriteEntry_ = anim.sprite();
 
@@ -482,11 +595,15 @@ void AnimationWindow::createGridAnimationGui(GridAnimation &anim)
 		ImGui::Combo("Function", &currentComboFunction, ui::comboString.data());
 		const GridFunction *gridFunction = (currentComboFunction > 0) ? &GridFunctionLibrary::gridFunctions()[currentComboFunction - 1] : nullptr;
 		if (anim.function() != gridFunction)
+		{
 			anim.setFunction(gridFunction);
+			ui_.invalidateFrames();
+		}
 
 		ImGui::SameLine();
 		bool isLocked = anim.isLocked();
-		ImGui::Checkbox(Labels::Locked, &isLocked);
+		if (ImGui::Checkbox(Labels::Locked, &isLocked))
+			ui_.invalidateFrames();
 		anim.setLocked(isLocked);
 
 		if (anim.function() != nullptr)
@@ -514,10 +631,12 @@ void AnimationWindow::createGridAnimationGui(GridAnimation &anim)
 				switch (paramInfo.type)
 				{
 					case GridFunction::ParameterType::FLOAT:
-						ImGui::SliderFloat(ui::auxString.data(), &anim.parameters()[i].value0, minValue, maxValue);
+						if (ImGui::SliderFloat(ui::auxString.data(), &anim.parameters()[i].value0, minValue, maxValue))
+							ui_.invalidateFrames();
 						break;
 					case GridFunction::ParameterType::VECTOR2F:
-						ImGui::SliderFloat2(ui::auxString.data(), &anim.parameters()[i].value0, minValue, maxValue);
+						if (ImGui::SliderFloat2(ui::auxString.data(), &anim.parameters()[i].value0, minValue, maxValue))
+							ui_.invalidateFrames();
 						break;
 				}
 
@@ -540,6 +659,7 @@ void AnimationWindow::createGridAnimationGui(GridAnimation &anim)
 				{
 					anim.parameters()[i].value0 = paramInfo.initialValue.value0;
 					anim.parameters()[i].value1 = paramInfo.initialValue.value1;
+					ui_.invalidateFrames();
 				}
 			}
 		}
@@ -565,6 +685,8 @@ void AnimationWindow::createScriptAnimationGui(ScriptAnimation &anim)
 	if (theSpriteMgr->sprites().isEmpty() == false)
 	{
 		const bool comboReturnValue = createCustomSpritesCombo(anim);
+		if (comboReturnValue)
+			ui_.invalidateFrames();
 		if (comboReturnValue && anim.sprite() != nullptr)
 			ui_.selectedSpriteEntry_ = anim.sprite();
 	}
@@ -595,11 +717,13 @@ void AnimationWindow::createScriptAnimationGui(ScriptAnimation &anim)
 		{
 			anim.setScript(theScriptingMgr->scripts()[scriptIndex].get());
 			ui_.selectedScriptIndex_ = scriptIndex;
+			ui_.invalidateFrames();
 		}
 
 		ImGui::SameLine();
 		bool isLocked = anim.isLocked();
-		ImGui::Checkbox(Labels::Locked, &isLocked);
+		if (ImGui::Checkbox(Labels::Locked, &isLocked))
+			ui_.invalidateFrames();
 		anim.setLocked(isLocked);
 	}
 	else
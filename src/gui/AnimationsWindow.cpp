@@ -1,3 +1,4 @@
+#include <cmath>
 #include <ncine/imgui_internal.h>
 
 #include "gui/AnimationsWindow.h"
@@ -16,6 +17,8 @@
 #include "ScriptManager.h"
 #include "SpriteManager.h"
 #include "SpriteEntry.h"
+#include "Canvas.h"
+#include "FrameCache.h"
 
 namespace {
 
@@ -24,6 +27,9 @@ const char *animationTypes[] = { "Parallel Group", "Sequential Group", "Property
 enum AnimationTypesEnum { PARALLEL_GROUP, SEQUENTIAL_GROUP, PROPERTY, GRID, SCRIPT };
 // clang-format on
 
+/// Maximum amount of texture memory used to cache the frames shown by the timeline
+const unsigned int FrameCacheMaxBytes = 256 * 1024 * 1024;
+
 IAnimation *removeAnimWithContextMenu = nullptr;
 bool editAnimName = false;
 
@@ -40,10 +46,13 @@ unsigned int nextAnimNameId()
 ///////////////////////////////////////////////////////////
 
 AnimationsWindow::AnimationsWindow(UserInterface &ui)
-    : ui_(ui)
+    : ui_(ui), isScrubbing_(false), scrubbedFrame_(0),
+      frameCache_(nctl::makeUnique<FrameCache>(FrameCacheMaxBytes))
 {
 }
 
+AnimationsWindow::~AnimationsWindow() = default;
+
 ///////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
@@ -68,6 +77,20 @@ void AnimationsWindow::removeAnimation()
 
 	theAnimMgr->removeAnimation(ui_.selectedAnimation_);
 	ui_.selectedAnimation_ = newSelection;
+	ui_.invalidateFrames();
+}
+
+void AnimationsWindow::renderScrubbedFrame(unsigned int projectRevision)
+{
+	if (frameCache_->restore(scrubbedFrame_, projectRevision, *theCanvas))
+		return;
+
+	theCanvas->bind();
+	const float inverseFps = ui_.renderWindow_.saveAnimStatus().inverseFps();
+	theAnimMgr->evaluateAt(scrubbedFrame_ * inverseFps, inverseFps);
+	theSpriteMgr->update();
+	theCanvas->unbind();
+	frameCache_->store(scrubbedFrame_, projectRevision, *theCanvas);
 }
 
 void AnimationsWindow::create()
@@ -136,6 +159,8 @@ void AnimationsWindow::create()
 				break;
 		}
 		(*anims)[selectedIndex]->setParent(parent);
+		theAnimMgr->invalidatePlan();
+		ui_.invalidateFrames();
 		ui_.selectedAnimation_ = (*anims)[selectedIndex].get();
 		if (ui_.selectedAnimation_->isGroup())
 			ui::auxString.format("AnimGroup%u", nextAnimNameId());
@@ -169,7 +194,11 @@ void AnimationsWindow::create()
 	ImGui::SeparatorEx(ImGuiSeparatorFlags_Vertical);
 	ImGui::SameLine();
 	if (ImGui::Button(Labels::Clone))
+	{
 		ui_.selectedAnimation_->parent()->anims().insertAt(++selectedIndex, nctl::move(ui_.selectedAnimation_->clone()));
+		theAnimMgr->invalidatePlan();
+		ui_.invalidateFrames();
+	}
 	ImGui::EndDisabled();
 
 	const bool enableControlButtons = ui_.selectedAnimation_ != nullptr && theAnimMgr->anims().isEmpty() == false;
@@ -201,14 +230,22 @@ void AnimationsWindow::create()
 	ImGui::BeginDisabled(enableMoveUpButton == false);
 	ImGui::SameLine();
 	if (ImGui::Button(Labels::MoveUp))
+	{
 		nctl::swap(ui_.selectedAnimation_->parent()->anims()[selectedIndex], ui_.selectedAnimation_->parent()->anims()[selectedIndex - 1]);
+		theAnimMgr->invalidatePlan();
+		ui_.invalidateFrames();
+	}
 	ImGui::EndDisabled();
 
 	const bool enableMoveDownButton = enableCloneButton && selectedIndex < ui_.selectedAnimation_->parent()->anims().size() - 1;
 	ImGui::BeginDisabled(enableMoveDownButton == false);
 	ImGui::SameLine();
 	if (ImGui::Button(Labels::MoveDown))
+	{
 		nctl::swap(ui_.selectedAnimation_->parent()->anims()[selectedIndex], ui_.selectedAnimation_->parent()->anims()[selectedIndex + 1]);
+		theAnimMgr->invalidatePlan();
+		ui_.invalidateFrames();
+	}
 	ImGui::EndDisabled();
 
 	if (ImGui::IsWindowHovered())
@@ -218,18 +255,32 @@ void AnimationsWindow::create()
 		ui_.enableKeyboardNav_ = false;
 
 		if (enableMoveUpButton && ImGui::IsKeyReleased(ImGuiKey_UpArrow))
+		{
 			nctl::swap(ui_.selectedAnimation_->parent()->anims()[selectedIndex], ui_.selectedAnimation_->parent()->anims()[selectedIndex - 1]);
+			theAnimMgr->invalidatePlan();
+			ui_.invalidateFrames();
+		}
 		if (enableMoveDownButton && ImGui::IsKeyReleased(ImGuiKey_DownArrow))
+		{
 			nctl::swap(ui_.selectedAnimation_->parent()->anims()[selectedIndex], ui_.selectedAnimation_->parent()->anims()[selectedIndex + 1]);
+			theAnimMgr->invalidatePlan();
+			ui_.invalidateFrames();
+		}
 	}
 
 	ImGui::PushItemWidth(ImGui::GetFontSize() * 16.0f);
-	ImGui::SliderFloat("Speed Multiplier", &theAnimMgr->speedMultiplier(), 0.0f, 5.0f);
+	if (ImGui::SliderFloat("Speed Multiplier", &theAnimMgr->speedMultiplier(), 0.0f, 5.0f))
+		ui_.invalidateFrames();
 	ImGui::PopItemWidth();
 	ImGui::SameLine();
 	ui::auxString.format("%s##Speed Multiplier", Labels::Reset);
 	if (ImGui::Button(ui::auxString.data()))
+	{
 		theAnimMgr->speedMultiplier() = 1.0f;
+		ui_.invalidateFrames();
+	}
+
+	createTimeline();
 
 	ImGui::Separator();
 
@@ -292,6 +343,8 @@ void AnimationsWindow::create()
 
 				dragAnimation->setParent(&theAnimMgr->animGroup());
 				theAnimMgr->anims().pushBack(nctl::move(dragAnimation));
+				theAnimMgr->invalidatePlan();
+				ui_.invalidateFrames();
 			}
 
 			ImGui::EndDragDropTarget();
@@ -314,6 +367,35 @@ void AnimationsWindow::create()
 // PRIVATE FUNCTIONS
 ///////////////////////////////////////////////////////////
 
+void AnimationsWindow::createTimeline()
+{
+	// Playing an animation leaves the timeline
+	if (isScrubbing_ && (theAnimMgr->state() == IAnimation::State::PLAYING ||
+	                     (ui_.selectedAnimation_ && ui_.selectedAnimation_->isPlaying())))
+	{
+		isScrubbing_ = false;
+	}
+
+	const SaveAnim &saveAnim = ui_.renderWindow_.saveAnimStatus();
+	// Animations that never stop are shown for the duration of the render
+	float duration = theAnimMgr->duration();
+	if (std::isinf(duration) || duration <= 0.0f)
+		duration = saveAnim.numFrames * saveAnim.inverseFps();
+	const int lastFrame = static_cast<int>(ceilf(duration * saveAnim.fps));
+	if (scrubbedFrame_ > lastFrame)
+		scrubbedFrame_ = lastFrame;
+
+	ImGui::Checkbox("Timeline", &isScrubbing_);
+	ImGui::BeginDisabled(isScrubbing_ == false);
+	ImGui::SameLine();
+	ImGui::PushItemWidth(ImGui::GetFontSize() * 16.0f);
+	ImGui::SliderInt("Frame", &scrubbedFrame_, 0, lastFrame);
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	ImGui::Text("%.3fs (%u cached)", scrubbedFrame_ * saveAnim.inverseFps(), frameCache_->numFrames());
+	ImGui::EndDisabled();
+}
+
 void AnimationsWindow::createAnimationListEntry(IAnimation &anim, unsigned int index, unsigned int &animId)
 {
 	static bool setFocus = false;
@@ -346,7 +428,11 @@ void AnimationsWindow::createAnimationListEntry(IAnimation &anim, unsigned int i
 	}
 
 	ui::auxString.format("%s###Anim%lu", anim.enabled ? Labels::EnabledAnimIcon : Labels::DisabledAnimIcon, reinterpret_cast<uintptr_t>(&anim));
-	ImGui::Checkbox(ui::auxString.data(), &anim.enabled);
+	if (ImGui::Checkbox(ui::auxString.data(), &anim.enabled))
+	{
+		theAnimMgr->invalidatePlan();
+		ui_.invalidateFrames();
+	}
 	ImGui::SameLine();
 
 	ui::auxString.clear();
@@ -487,7 +573,11 @@ void AnimationsWindow::createAnimationListEntry(IAnimation &anim, unsigned int i
 		ImGui::Separator();
 
 		if (ImGui::MenuItem(Labels::Clone))
+		{
 			ui_.selectedAnimation_->parent()->anims().insertAt(++index, nctl::move(ui_.selectedAnimation_->clone()));
+			theAnimMgr->invalidatePlan();
+			ui_.invalidateFrames();
+		}
 		if (ImGui::MenuItem(Labels::Remove))
 			removeAnimWithContextMenu = &anim;
 
@@ -540,6 +630,8 @@ void AnimationsWindow::createAnimationListEntry(IAnimation &anim, unsigned int i
 					dragAnimation->setParent(anim.parent());
 					anim.parent()->anims().insertAt(index, nctl::move(dragAnimation));
 				}
+				theAnimMgr->invalidatePlan();
+				ui_.invalidateFrames();
 			}
 		}
 
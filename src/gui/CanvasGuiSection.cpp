@@ -14,7 +14,7 @@ const char *ResizeStrings[7] = { "16x16", "32x32", "64x64", "128x128", "256x256"
 // PUBLIC FUNCTIONS
 ///////////////////////////////////////////////////////////
 
-void CanvasGuiSection::create(Canvas &canvas)
+bool CanvasGuiSection::create(Canvas &canvas)
 {
 	ui::auxString.format("Zoom: %.2f", zoomAmount());
 	const ImVec2 closeItemSpacing(ImGui::GetStyle().ItemSpacing.x * 0.5f, ImGui::GetStyle().ItemSpacing.y * 0.5f);
@@ -31,7 +31,7 @@ void CanvasGuiSection::create(Canvas &canvas)
 		resetZoom();
 
 	ImGui::SameLine();
-	ImGui::ColorEdit4("Background", canvas.backgroundColor.data(), ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_NoInputs);
+	bool edited = ImGui::ColorEdit4("Background", canvas.backgroundColor.data(), ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_NoInputs);
 	ImGui::SameLine();
 
 	int currentResizeCombo = static_cast<int>(resizePreset_);
@@ -84,12 +84,17 @@ void CanvasGuiSection::create(Canvas &canvas)
 		desiredCanvasSize.y = canvas.maxTextureSize();
 
 	if (valueChanged && (canvas.size().x != desiredCanvasSize.x || canvas.size().y != desiredCanvasSize.y))
+	{
 		canvas.resizeTexture(desiredCanvasSize);
+		edited = true;
+	}
 
 	ImGui::SameLine();
 	ImGui::Checkbox("Borders", &showBorders_);
 
 	ImGui::Separator();
+
+	return edited;
 }
 
 void CanvasGuiSection::setResize(const nc::Vector2i &size)
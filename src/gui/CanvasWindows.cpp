@@ -32,7 +32,8 @@ void CanvasWindows::createCanvasWindow()
 	ImGui::Begin(Labels::Canvas, nullptr, ImGuiWindowFlags_HorizontalScrollbar);
 	if (ImGui::IsWindowHovered())
 		hoveringOnCanvasWindow_ = true;
-	ui_.canvasGuiSection_.create(*theCanvas);
+	if (ui_.canvasGuiSection_.create(*theCanvas))
+		ui_.invalidateFrames();
 
 	const ImVec2 cursorScreenPos = ImGui::GetCursorScreenPos();
 	ImGui::Image(static_cast<ImTextureID>(reinterpret_cast<intptr_t>(theCanvas->imguiTexId())),
@@ -99,6 +100,7 @@ void CanvasWindows::createCanvasWindow()
 					// Update grid anchor point while pressing Ctrl, clicking and moving the mouse
 					sprite.gridAnchorPoint = spriteRelativePos;
 					theAnimMgr->assignGridAnchorToParameters(&sprite);
+					ui_.invalidateFrames();
 				}
 			}
 			if (ImGui::GetIO().KeyShift && ImGui::IsMouseReleased(ImGuiMouseButton_Left))
@@ -108,6 +110,7 @@ void CanvasWindows::createCanvasWindow()
 				// Update sprite anchor point while pressing Shift and releasing the mouse button
 				sprite.anchorPoint = spriteRelativePos;
 				sprite.setAbsPosition(newSpriteAbsPos);
+				ui_.invalidateFrames();
 			}
 		}
 		else
@@ -121,13 +124,17 @@ void CanvasWindows::createCanvasWindow()
 					// Update sprite anchor point while clicking the mouse button and releasing the Shift key
 					sprite.anchorPoint = spriteRelativePos;
 					sprite.setAbsPosition(newSpriteAbsPos);
+					ui_.invalidateFrames();
 				}
 			}
 			else if (ImGui::GetIO().KeyAlt && (ImGui::IsMouseDragging(ImGuiMouseButton_Left, 1.0f) || ImGui::IsMouseReleased(ImGuiMouseButton_Left)))
 			{
 				// Update sprite position while pressing Alt, clicking and moving the mouse (with pixel snapping)
 				if (sprite.absPosition().x != newSpriteAbsPos.x || sprite.absPosition().y != newSpriteAbsPos.y)
+				{
 					sprite.setAbsPosition(newSpriteAbsPos);
+					ui_.invalidateFrames();
+				}
 			}
 
 			shiftAndClick = false;
@@ -138,7 +138,9 @@ void RenderWindow::create()
 	saveAnimStatus_.canvasResize = resizeAmount();
 
 	const unsigned int MaxSliderSeconds = 10;
-	ImGui::InputInt("FPS", &saveAnimStatus_.fps);
+	// The timeline frames are spaced by the inverse of the frame rate
+	if (ImGui::InputInt("FPS", &saveAnimStatus_.fps))
+		ui_.invalidateFrames();
 	ImGui::SliderInt("Num Frames", &saveAnimStatus_.numFrames, 1, MaxSliderSeconds * saveAnimStatus_.fps); // Hard-coded limit
 	float duration = saveAnimStatus_.numFrames * saveAnimStatus_.inverseFps();
 	ImGui::SliderFloat("Duration", &duration, 0.0f, MaxSliderSeconds, "%.3fs"); // Hard-coded limit
@@ -361,7 +363,11 @@ void RenderWindow::cancelRender()
 	if (shouldSaveFrames_ || shouldSaveSpritesheet_)
 	{
 		if (shouldSaveFrames_)
-			ui::auxString.format("Render cancelled, saved %d out of %d frames", saveAnimStatus_.numSavedFrames, saveAnimStatus_.numFrames);
+		{
+			// The readbacks still in flight are going to be dropped
+			const int numWrittenFrames = saveAnimStatus_.numSavedFrames - static_cast<int>(theCanvas->numPendingSaves() + theResizedCanvas->numPendingSaves());
+			ui::auxString.format("Render cancelled, saved %d out of %d frames", numWrittenFrames, saveAnimStatus_.numFrames);
+		}
 		else if (shouldSaveSpritesheet_)
 			ui::auxString = "Render cancelled, the spritesheet has not been saved";
 		ui_.pushStatusInfoMessage(ui::auxString.data());
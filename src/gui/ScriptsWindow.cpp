@@ -8,6 +8,7 @@
 #include "gui/FileDialog.h"
 #include "Script.h"
 #include "ScriptManager.h"
+#include "ScriptAnimation.h"
 #include "AnimationManager.h"
 
 #include "scripts_strings.h"
@@ -120,6 +121,8 @@ void ScriptsWindow::create()
 				ImGui::EndPopup();
 			}
 		}
+
+		createProfilerGui();
 	}
 
 	ImGui::End();
@@ -172,6 +175,7 @@ void ScriptsWindow::reloadScript() // TODO: Move back to ui?
 		Script *script = theScriptingMgr->scripts()[ui_.selectedScriptIndex_].get();
 		script->reload();
 		theAnimMgr->reloadScript(script);
+		ui_.invalidateFrames();
 
 		ui::auxString.format("Reloaded script \"%s\"\n", script->name().data());
 		ui_.pushStatusInfoMessage(ui::auxString.data());
@@ -182,10 +186,75 @@ void ScriptsWindow::reloadScript() // TODO: Move back to ui?
 // PRIVATE FUNCTIONS
 ///////////////////////////////////////////////////////////
 
+void ScriptsWindow::createProfilerGui()
+{
+	ImGui::Separator();
+	if (ImGui::CollapsingHeader("Profiler") == false)
+		return;
+
+	// The selected script could have been removed from the context menu of the list
+	const nctl::Array<nctl::UniquePtr<Script>> &scripts = theScriptingMgr->scripts();
+	if (scripts.isEmpty() || ui_.selectedScriptIndex_ < 0 || ui_.selectedScriptIndex_ >= static_cast<int>(scripts.size()))
+		return;
+
+	Script &script = *scripts[ui_.selectedScriptIndex_];
+	scriptAnims_.clear();
+	theAnimMgr->retrieveScriptAnimations(&script, scriptAnims_);
+
+	if (ImGui::Button(Labels::Reset))
+	{
+		script.resetProfile();
+		for (ScriptAnimation *scriptAnim : scriptAnims_)
+			scriptAnim->resetProfile();
+	}
+
+	const ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+	if (ImGui::BeginTable("ScriptProfiler", 7, tableFlags))
+	{
+		ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableSetupColumn("Total ms");
+		ImGui::TableSetupColumn("Average ms");
+		ImGui::TableSetupColumn("Peak ms");
+		ImGui::TableSetupColumn("Memory KiB");
+		ImGui::TableSetupColumn("Calls that freed memory");
+		ImGui::TableHeadersRow();
+
+		createProfileRow(nc::fs::baseName(script.name().data()).data(), script.profile());
+		for (const ScriptAnimation *scriptAnim : scriptAnims_)
+		{
+			ui::auxString.format("  %s", scriptAnim->name.data());
+			createProfileRow(ui::auxString.data(), scriptAnim->profile());
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+void ScriptsWindow::createProfileRow(const char *name, const ScriptProfile &profile)
+{
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	ImGui::TextUnformatted(name);
+	ImGui::TableNextColumn();
+	ImGui::Text("%u", profile.numCalls);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", profile.totalTime * 1000.0f);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", profile.averageTime() * 1000.0f);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", profile.peakTime * 1000.0f);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.1f", profile.memoryDelta / 1024.0f);
+	ImGui::TableNextColumn();
+	ImGui::Text("%u", profile.callsFreeingMemory);
+}
+
 void ScriptsWindow::removeScript()
 {
 	Script *selectedScript = theScriptingMgr->scripts()[ui_.selectedScriptIndex_].get();
 	theAnimMgr->removeScript(selectedScript);
+	ui_.invalidateFrames();
 
 	theScriptingMgr->scripts().removeAt(ui_.selectedScriptIndex_);
 	if (ui_.selectedScriptIndex_ > 0)
@@ -39,6 +39,7 @@ void SpriteWindow::create()
 	if (ui_.selectedSpriteEntry_->isSprite())
 	{
 		Sprite &sprite = *ui_.selectedSpriteEntry_->toSprite();
+		bool edited = false;
 
 		ImGui::InputText("Name", sprite.name.data(), Sprite::MaxNameLength,
 		                 ImGuiInputTextFlags_CallbackResize, ui::inputTextCallback, &sprite.name);
@@ -55,7 +56,7 @@ void SpriteWindow::create()
 		// Append a second '\0' to signal the end of the combo item list
 		ui::comboString[ui::comboString.length() - 1] = '\0';
 
-		ImGui::Combo("Texture", &currentTextureCombo, ui::comboString.data());
+		edited |= ImGui::Combo("Texture", &currentTextureCombo, ui::comboString.data());
 		Texture *newTexture = theSpriteMgr->textures()[currentTextureCombo].get();
 		if (&sprite.texture() != newTexture)
 		{
@@ -151,26 +152,31 @@ void SpriteWindow::create()
 			const nc::Vector2f absPosition = sprite.absPosition();
 			sprite.setParent(parentSprite);
 			sprite.setAbsPosition(absPosition);
+			edited = true;
 		}
 
 		ImGui::Separator();
 
 		nc::Vector2f position(sprite.x, sprite.y);
-		ImGui::SliderFloat2("Position", position.data(), 0.0f, static_cast<float>(theCanvas->texWidth()));
+		edited |= ImGui::SliderFloat2("Position", position.data(), 0.0f, static_cast<float>(theCanvas->texWidth()));
 		sprite.x = roundf(position.x);
 		sprite.y = roundf(position.y);
-		ImGui::SliderFloat("Rotation", &sprite.rotation, 0.0f, 360.0f);
-		ImGui::SliderFloat2("Scale", sprite.scaleFactor.data(), 0.0f, 8.0f);
+		edited |= ImGui::SliderFloat("Rotation", &sprite.rotation, 0.0f, 360.0f);
+		edited |= ImGui::SliderFloat2("Scale", sprite.scaleFactor.data(), 0.0f, 8.0f);
 		ImGui::SameLine();
 		ui::auxString.format("%s##Scale", Labels::Reset);
 		if (ImGui::Button(ui::auxString.data()))
+		{
 			sprite.scaleFactor.set(1.0f, 1.0f);
+			edited = true;
+		}
 
 		const float halfBiggerDimension = sprite.width() > sprite.height() ? sprite.width() * 0.5f : sprite.height() * 0.5f;
-		ImGui::SliderFloat2("Anchor Point", sprite.anchorPoint.data(), -halfBiggerDimension, halfBiggerDimension);
+		edited |= ImGui::SliderFloat2("Anchor Point", sprite.anchorPoint.data(), -halfBiggerDimension, halfBiggerDimension);
 		static int currentAnchorSelection = 0;
 		if (ImGui::Combo("Anchor Presets", &currentAnchorSelection, anchorPointItems, IM_COUNTOF(anchorPointItems)))
 		{
+			edited = true;
 			switch (currentAnchorSelection)
 			{
 				case AnchorPointsEnum::CENTER:
@@ -233,33 +239,50 @@ void SpriteWindow::create()
 		    texRect.w != currentTexRect.w || texRect.h != currentTexRect.h)
 		{
 			sprite.setTexRect(texRect);
+			edited = true;
 		}
 
 		bool isFlippedX = sprite.isFlippedX();
-		ImGui::Checkbox("Flipped X", &isFlippedX);
+		edited |= ImGui::Checkbox("Flipped X", &isFlippedX);
 		ImGui::SameLine();
 		bool isFlippedY = sprite.isFlippedY();
-		ImGui::Checkbox("Flipped Y", &isFlippedY);
+		edited |= ImGui::Checkbox("Flipped Y", &isFlippedY);
 
 		if (isFlippedX != sprite.isFlippedX())
 			sprite.setFlippedX(isFlippedX);
 		if (isFlippedY != sprite.isFlippedY())
 			sprite.setFlippedY(isFlippedY);
 
+		int gridCellSize = sprite.gridCellSize();
+		edited |= ImGui::SliderInt("Grid Cell Size", &gridCellSize, 1, Sprite::MaxGridCellSize);
+		if (gridCellSize != sprite.gridCellSize())
+			sprite.setGridCellSize(gridCellSize);
+		if (sprite.isMeshSprite())
+		{
+			ImGui::SameLine();
+			ImGui::Text("%d x %d", sprite.gridWidth(), sprite.gridHeight());
+		}
+
 		ImGui::Separator();
 		int currentRgbBlendingPreset = static_cast<int>(sprite.rgbBlendingPreset());
-		ImGui::Combo("RGB Blending", &currentRgbBlendingPreset, blendingPresets, IM_COUNTOF(blendingPresets));
+		edited |= ImGui::Combo("RGB Blending", &currentRgbBlendingPreset, blendingPresets, IM_COUNTOF(blendingPresets));
 		sprite.setRgbBlendingPreset(static_cast<Sprite::BlendingPreset>(currentRgbBlendingPreset));
 
 		int currentAlphaBlendingPreset = static_cast<int>(sprite.alphaBlendingPreset());
-		ImGui::Combo("Alpha Blending", &currentAlphaBlendingPreset, blendingPresets, IM_COUNTOF(blendingPresets));
+		edited |= ImGui::Combo("Alpha Blending", &currentAlphaBlendingPreset, blendingPresets, IM_COUNTOF(blendingPresets));
 		sprite.setAlphaBlendingPreset(static_cast<Sprite::BlendingPreset>(currentAlphaBlendingPreset));
 
-		ImGui::ColorEdit4("Color", sprite.color.data(), ImGuiColorEditFlags_AlphaBar);
+		edited |= ImGui::ColorEdit4("Color", sprite.color.data(), ImGuiColorEditFlags_AlphaBar);
 		ImGui::SameLine();
 		ui::auxString.format("%s##Color", Labels::Reset);
 		if (ImGui::Button(ui::auxString.data()))
+		{
 			sprite.color = nc::Colorf::White;
+			edited = true;
+		}
+
+		if (edited)
+			ui_.invalidateFrames();
 	}
 
 	ImGui::End();
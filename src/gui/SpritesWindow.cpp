@@ -111,6 +111,7 @@ void SpritesWindow::create()
 				addedSprite->name = ui::auxString;
 				ui_.selectedSpriteEntry_ = addedSprite;
 				theSpriteMgr->updateSpritesArray();
+				ui_.invalidateFrames();
 			}
 		}
 		ImGui::SameLine();
@@ -121,6 +122,7 @@ void SpritesWindow::create()
 			addedGroup->name() = ui::auxString;
 			ui_.selectedSpriteEntry_ = addedGroup;
 			theSpriteMgr->updateSpritesArray();
+			ui_.invalidateFrames();
 		}
 
 		const bool enableRemoveButton = theSpriteMgr->children().isEmpty() == false && ui_.selectedSpriteEntry_ != &theSpriteMgr->root();
@@ -156,7 +158,10 @@ void SpritesWindow::create()
 		const bool enableMoveUpButton = enableCloneButton && indexInParent < parentGroup->children().size() - 1;
 		ImGui::BeginDisabled(enableMoveUpButton == false);
 		if (ImGui::Button(Labels::MoveUp))
+		{
 			moveSpriteEntry(*ui_.selectedSpriteEntry_, indexInParent, true);
+			ui_.invalidateFrames();
+		}
 		ImGui::EndDisabled();
 
 		ImGui::SameLine();
@@ -164,7 +169,10 @@ void SpritesWindow::create()
 		const bool enableMoveDownButton = enableCloneButton && indexInParent > 0;
 		ImGui::BeginDisabled(enableMoveDownButton == false);
 		if (ImGui::Button(Labels::MoveDown))
+		{
 			moveSpriteEntry(*ui_.selectedSpriteEntry_, indexInParent, false);
+			ui_.invalidateFrames();
+		}
 		ImGui::EndDisabled();
 
 		if (ImGui::IsWindowHovered())
@@ -174,9 +182,15 @@ void SpritesWindow::create()
 			ui_.enableKeyboardNav_ = false;
 
 			if (enableMoveUpButton && ImGui::IsKeyReleased(ImGuiKey_UpArrow))
+			{
 				moveSpriteEntry(*ui_.selectedSpriteEntry_, indexInParent, true);
+				ui_.invalidateFrames();
+			}
 			if (enableMoveDownButton && ImGui::IsKeyReleased(ImGuiKey_DownArrow))
+			{
 				moveSpriteEntry(*ui_.selectedSpriteEntry_, indexInParent, false);
+				ui_.invalidateFrames();
+			}
 		}
 
 		ImGui::Separator();
@@ -213,6 +227,7 @@ void SpritesWindow::create()
 				dragEntry->setParentGroup(&theSpriteMgr->root());
 				theSpriteMgr->children().pushBack(nctl::move(dragEntry));
 				theSpriteMgr->updateSpritesArray();
+				ui_.invalidateFrames();
 			}
 
 			ImGui::EndDragDropTarget();
@@ -259,7 +274,8 @@ void SpritesWindow::createSpriteListEntry(SpriteEntry &entry, unsigned int index
 			nodeFlags |= ImGuiTreeNodeFlags_Selected;
 
 		ui::auxString.format("%s###Sprite%lu", sprite->visible ? Labels::VisibleIcon : Labels::InvisibleIcon, reinterpret_cast<uintptr_t>(sprite));
-		ImGui::Checkbox(ui::auxString.data(), &sprite->visible);
+		if (ImGui::Checkbox(ui::auxString.data(), &sprite->visible))
+			ui_.invalidateFrames();
 		ImGui::SameLine();
 
 		ui::auxString.format("#%u: \"%s\" (%d x %d) %s", sprite->spriteId(), sprite->name.data(), sprite->width(), sprite->height(),
@@ -427,6 +443,7 @@ void SpritesWindow::createSpriteListEntry(SpriteEntry &entry, unsigned int index
 					entry.parentGroup()->children().insertAt(index, nctl::move(dragEntry));
 				}
 				theSpriteMgr->updateSpritesArray();
+				ui_.invalidateFrames();
 			}
 		}
 
@@ -457,6 +474,7 @@ void SpritesWindow::cloneSprite()
 	recursiveCloneSprite(selectedSprite, clonedSprite);
 
 	theSpriteMgr->updateSpritesArray();
+	ui_.invalidateFrames();
 	ui_.selectedSpriteEntry_ = clonedSprite;
 }
 
@@ -471,6 +489,7 @@ void SpritesWindow::cloneSpriteGroup()
 	clonedGroup->setParentGroup(ui_.selectedSpriteEntry_->parentGroup());
 
 	theSpriteMgr->updateSpritesArray();
+	ui_.invalidateFrames();
 	ui_.selectedSpriteEntry_ = clonedGroup;
 }
 
@@ -499,6 +518,7 @@ void SpritesWindow::removeSprite()
 	theAnimMgr->removeSprite(selectedSprite);
 	updateParentOnSpriteRemoval(selectedSprite);
 	theSpriteMgr->updateSpritesArray();
+	ui_.invalidateFrames();
 	ui_.selectedSpriteEntry_ = newSelection;
 }
 
@@ -542,5 +562,6 @@ void SpritesWindow::removeSpriteGroup()
 	children.removeAt(index);
 
 	theSpriteMgr->updateSpritesArray();
+	ui_.invalidateFrames();
 	ui_.selectedSpriteEntry_ = newSelection;
 }
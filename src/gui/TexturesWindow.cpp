@@ -201,6 +201,7 @@ bool TexturesWindow::reloadTexture(const char *filename)
 {
 	nctl::UniquePtr<Texture> &texture = theSpriteMgr->textures()[ui_.selectedTextureIndex_];
 	texture->loadFromFile(filename);
+	ui_.invalidateFrames();
 	return postLoadTexture(texture, filename);
 }
 
@@ -222,6 +223,7 @@ bool TexturesWindow::reloadTexture(const char *bufferName, const char *bufferPtr
 {
 	nctl::UniquePtr<Texture> &texture = theSpriteMgr->textures()[ui_.selectedTextureIndex_];
 	texture->loadFromMemory(bufferName, reinterpret_cast<const unsigned char *>(bufferPtr), bufferSize);
+	ui_.invalidateFrames();
 	return postLoadTexture(texture, bufferName);
 }
 #endif
@@ -283,6 +285,7 @@ void TexturesWindow::removeTexture()
 
 	theSpriteMgr->textures().removeAt(ui_.selectedTextureIndex_);
 	theSpriteMgr->updateSpritesArray();
+	ui_.invalidateFrames();
 	if (ui_.selectedTextureIndex_ > 0)
 		ui_.selectedTextureIndex_--;
 }
@@ -150,6 +150,16 @@ void UserInterface::cancelRender()
 	renderWindow_.cancelRender();
 }
 
+bool UserInterface::isScrubbing() const
+{
+	return animationsWindow_.isScrubbing();
+}
+
+void UserInterface::renderScrubbedFrame()
+{
+	animationsWindow_.renderScrubbedFrame(projectRevision_);
+}
+
 void UserInterface::changeScalingFactor(float factor)
 {
 	ImGuiStyle &style = ImGui::GetStyle();
@@ -191,6 +201,7 @@ void UserInterface::moveSprite(int xDiff, int yDiff)
 		Sprite *sprite = selectedSpriteEntry_->toSprite();
 		sprite->x += xDiff;
 		sprite->y += yDiff;
+		projectRevision_++;
 	}
 }
 
@@ -233,6 +244,7 @@ void UserInterface::menuNew()
 	theAnimMgr->clear();
 	theScriptingMgr->clear();
 	theSpriteMgr->clear();
+	projectRevision_++;
 }
 
 void UserInterface::menuOpen()
@@ -422,6 +434,7 @@ bool UserInterface::openProject(const char *filename)
 		renderWindow_.setResize(renderWindow_.saveAnimStatus().canvasResize);
 
 		lastLoadedProject_ = filename;
+		projectRevision_++;
 		ui::auxString.format("Loaded project file \"%s\"\n", filename);
 		pushStatusInfoMessage(ui::auxString.data());
 
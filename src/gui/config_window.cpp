@@ -7,6 +7,7 @@
 #include "gui/gui_labels.h"
 #include "Configuration.h"
 #include "LuaSaver.h"
+#include "ScriptManager.h"
 
 bool UserInterface::showConfigWindow = false;
 
@@ -161,6 +162,28 @@ void UserInterface::createConfigWindow()
 	ImGui::NewLine();
 	ImGui::SliderInt("Canvas Width", &theCfg.canvasWidth, 0, 1024);
 	ImGui::SliderInt("Canvas Height", &theCfg.canvasHeight, 0, 1024);
+	ImGui::Checkbox("Batch Sprites", &theCfg.batchSprites);
+	ImGui::BeginDisabled(theCfg.batchSprites == false);
+	ImGui::SameLine();
+	ImGui::Checkbox("Instanced", &theCfg.instancedSprites);
+	ImGui::EndDisabled();
+	ImGui::Checkbox("Grid Functions on GPU", &theCfg.shaderGridFunctions);
+
+	ImGui::NewLine();
+	ImGui::Checkbox("Shared Script State", &theCfg.sharedScriptState);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Loads scripts in a single Lua state, each one with its own environment");
+	if (ImGui::InputInt("Script Instruction Budget", &theCfg.scriptInstructionBudget, 1000000, 10000000))
+		theScriptingMgr->applyJitMode();
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Stops a script function after this number of instructions, zero to disable\nThe LuaJIT compiler is switched off while a budget is set");
+	bool gcChanged = ImGui::Checkbox("Generational Script GC", &theCfg.scriptGenerationalGc);
+	ImGui::BeginDisabled(theCfg.scriptGenerationalGc);
+	gcChanged |= ImGui::SliderInt("Script GC Pause", &theCfg.scriptGcPause, 50, 400, "%d%%");
+	gcChanged |= ImGui::SliderInt("Script GC Step Multiplier", &theCfg.scriptGcStepMultiplier, 50, 1000, "%d%%");
+	ImGui::EndDisabled();
+	if (gcChanged)
+		theScriptingMgr->applyGcSettings();
 
 	ImGui::NewLine();
 	if (ImGui::Checkbox("Automatic GUI Scaling", &theCfg.autoGuiScaling))
@@ -219,6 +242,13 @@ void UserInterface::sanitizeConfigValues()
 	if (theCfg.canvasHeight < 16)
 		theCfg.canvasHeight = 16;
 
+	if (theCfg.scriptInstructionBudget < 0)
+		theCfg.scriptInstructionBudget = 0;
+	if (theCfg.scriptGcPause < 50)
+		theCfg.scriptGcPause = 50;
+	if (theCfg.scriptGcStepMultiplier < 50)
+		theCfg.scriptGcStepMultiplier = 50;
+
 	if (theCfg.autoGuiScaling == false)
 	{
 		if (theCfg.guiScaling < 0.5f)
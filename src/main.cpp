@@ -31,10 +31,14 @@
 #include "SequentialAnimationGroup.h"
 #include "LuaSaver.h"
 #include "ScriptManager.h"
+#include "PngSaverPool.h"
+#include "Benchmarks.h"
 
 #include <ncine/Application.h>
 #include <ncine/FileSystem.h>
 #include <ncine/IFile.h>
+#include <ncine/TimeStamp.h>
+#include <nctl/algorithms.h>
 
 #if defined(__ANDROID__)
 	#include <ncine/AndroidApplication.h>
@@ -42,6 +46,191 @@
 	const char *linuxConfigDir = ".config/spookyghost";
 #endif
 
+namespace {
+
+/// Batch render settings parsed from the command line
+struct CommandLineRender
+{
+	bool enabled = false;
+	bool spritesheet = false;
+	nctl::String projectFile = nctl::String(nc::fs::MaxPathLength);
+	nctl::String outDirectory = nctl::String(nc::fs::MaxPathLength);
+	nctl::String prefix = nctl::String(nc::fs::MaxPathLength);
+	SaveAnim saveAnim;
+};
+
+CommandLineRender cmdRender;
+/// Runs the grid kernels benchmark instead of starting the interface
+bool cmdBenchmarkGrid = false;
+/// Runs the easing curves benchmark instead of starting the interface
+bool cmdBenchmarkEasing = false;
+
+/// Maximum time spent rendering animation frames to save before updating the interface
+const float SaveAnimBatchBudgetMs = 12.0f;
+
+void printUsage()
+{
+	LOGI("Usage: spookyghost --render <project.lua> [--out <dir>] [--prefix <name>] [--fps <n>] [--frames <n>] [--resize <factor>] [--spritesheet]");
+	LOGI("       spookyghost --benchmark-grid");
+	LOGI("       spookyghost --benchmark-easing");
+}
+
+/// Returns true if the command line asks for a batch render or a benchmark
+bool parseCommandLine(const nc::AppConfiguration &config)
+{
+	for (int i = 1; i < config.argc(); i++)
+	{
+		const char *arg = config.argv(i);
+		const bool hasValue = (i + 1 < config.argc());
+
+		if (strcmp(arg, "--render") == 0 && hasValue)
+		{
+			cmdRender.projectFile = config.argv(++i);
+			cmdRender.enabled = true;
+		}
+		else if (strcmp(arg, "--out") == 0 && hasValue)
+			cmdRender.outDirectory = config.argv(++i);
+		else if (strcmp(arg, "--prefix") == 0 && hasValue)
+			cmdRender.prefix = config.argv(++i);
+		else if (strcmp(arg, "--fps") == 0 && hasValue)
+			cmdRender.saveAnim.fps = atoi(config.argv(++i));
+		else if (strcmp(arg, "--frames") == 0 && hasValue)
+			cmdRender.saveAnim.numFrames = atoi(config.argv(++i));
+		else if (strcmp(arg, "--resize") == 0 && hasValue)
+			cmdRender.saveAnim.canvasResize = static_cast<float>(atof(config.argv(++i)));
+		else if (strcmp(arg, "--spritesheet") == 0)
+			cmdRender.spritesheet = true;
+		else if (strcmp(arg, "--benchmark-grid") == 0)
+			cmdBenchmarkGrid = true;
+		else if (strcmp(arg, "--benchmark-easing") == 0)
+			cmdBenchmarkEasing = true;
+		else
+		{
+			LOGW_X("Unknown or incomplete command line option: \"%s\"", arg);
+			printUsage();
+		}
+	}
+
+	if (cmdBenchmarkGrid || cmdBenchmarkEasing)
+		return true;
+	if (cmdRender.enabled == false)
+		return false;
+
+	if (cmdRender.saveAnim.fps < 1)
+		cmdRender.saveAnim.fps = 1;
+	if (cmdRender.saveAnim.numFrames < 1)
+		cmdRender.saveAnim.numFrames = 1;
+	if (cmdRender.saveAnim.canvasResize <= 0.0f)
+		cmdRender.saveAnim.canvasResize = 1.0f;
+
+	if (cmdRender.outDirectory.isEmpty())
+		cmdRender.outDirectory = nc::fs::currentDir();
+	if (cmdRender.prefix.isEmpty())
+	{
+		cmdRender.prefix = nc::fs::baseName(cmdRender.projectFile.data());
+		if (nc::fs::hasExtension(cmdRender.prefix.data(), "lua"))
+			cmdRender.prefix.setLength(cmdRender.prefix.length() - 4);
+	}
+
+	return true;
+}
+
+/// Renders all the frames requested from the command line, without waiting for the next application frame
+void renderFromCommandLine()
+{
+	SaveAnim &saveAnim = cmdRender.saveAnim;
+	const bool resizeCanvas = (saveAnim.canvasResize != 1.0f);
+
+	if (nc::fs::isDirectory(cmdRender.outDirectory.data()) == false)
+		nc::fs::createDir(cmdRender.outDirectory.data());
+
+	const nc::Vector2i canvasSize(theCanvas->texWidth(), theCanvas->texHeight());
+	const nc::Vector2i frameSize(nctl::max(1, static_cast<int>(canvasSize.x * saveAnim.canvasResize)),
+	                             nctl::max(1, static_cast<int>(canvasSize.y * saveAnim.canvasResize)));
+	if (resizeCanvas)
+		theResizedCanvas->resizeTexture(frameSize);
+	Canvas *sourceCanvas = resizeCanvas ? theResizedCanvas.get() : theCanvas.get();
+
+	int sheetColumns = 1;
+	if (cmdRender.spritesheet)
+	{
+		sheetColumns = static_cast<int>(ceilf(sqrtf(static_cast<float>(saveAnim.numFrames))));
+		const int maxColumns = nctl::max(1, theSpritesheet->maxTextureSize() / frameSize.x);
+		if (sheetColumns > maxColumns)
+			sheetColumns = maxColumns;
+		const int sheetRows = (saveAnim.numFrames + sheetColumns - 1) / sheetColumns;
+		const int maxRows = nctl::max(1, theSpritesheet->maxTextureSize() / frameSize.y);
+		if (sheetRows > maxRows)
+		{
+			LOGW_X("Spritesheet can only hold %d frames out of %d", sheetColumns * maxRows, saveAnim.numFrames);
+			saveAnim.numFrames = sheetColumns * maxRows;
+		}
+		theSpritesheet->resizeTexture(frameSize.x * sheetColumns, frameSize.y * ((saveAnim.numFrames + sheetColumns - 1) / sheetColumns));
+	}
+
+	// Reset to initial state before playing
+	theAnimMgr->stop();
+	theAnimMgr->play();
+	theAnimMgr->update(0.0f);
+
+	saveAnim.numSavedFrames = 0;
+	for (int frame = 0; frame < saveAnim.numFrames; frame++)
+	{
+		theCanvas->bind();
+		theSpriteMgr->update();
+		theCanvas->unbind();
+
+		if (frame == 0 && cmdRender.spritesheet)
+		{
+			theSpritesheet->bindDraw();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+			theSpritesheet->unbind();
+		}
+
+		if (resizeCanvas)
+		{
+			theCanvas->bindRead();
+			theResizedCanvas->bindDraw();
+			glBlitFramebuffer(0, 0, theCanvas->texWidth(), theCanvas->texHeight(), 0, 0, theResizedCanvas->texWidth(), theResizedCanvas->texHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			theCanvas->unbind();
+			theResizedCanvas->unbind();
+		}
+
+		if (cmdRender.spritesheet)
+		{
+			saveAnim.sheetDestPos.set((frame % sheetColumns) * frameSize.x, (frame / sheetColumns) * frameSize.y);
+			sourceCanvas->bindRead();
+			theSpritesheet->bindTexture();
+			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, saveAnim.sheetDestPos.x, saveAnim.sheetDestPos.y, 0, 0, sourceCanvas->texWidth(), sourceCanvas->texHeight());
+			sourceCanvas->unbind();
+			theSpritesheet->unbindTexture();
+		}
+		else
+		{
+			saveAnim.filename.format("%s_%03d.png", cmdRender.prefix.data(), frame);
+			saveAnim.filename = nc::fs::joinPath(cmdRender.outDirectory, saveAnim.filename);
+			sourceCanvas->save(saveAnim.filename.data(), *thePngSaverPool);
+		}
+
+		saveAnim.numSavedFrames++;
+		theAnimMgr->update(saveAnim.inverseFps());
+	}
+
+	if (cmdRender.spritesheet)
+	{
+		saveAnim.filename.format("%s.png", cmdRender.prefix.data());
+		saveAnim.filename = nc::fs::joinPath(cmdRender.outDirectory, saveAnim.filename);
+		theSpritesheet->save(saveAnim.filename.data());
+	}
+	sourceCanvas->finishSaves(*thePngSaverPool);
+	thePngSaverPool->waitAll();
+	theAnimMgr->stop();
+
+	LOGI_X("Rendered %u frames of \"%s\" at %d FPS to \"%s\"", saveAnim.numSavedFrames, cmdRender.projectFile.data(), saveAnim.fps, cmdRender.outDirectory.data());
+}
+
+}
+
 nctl::UniquePtr<nc::IAppEventHandler> createAppEventHandler()
 {
 	return nctl::makeUnique<MyEventHandler>();
@@ -145,9 +334,19 @@ void MyEventHandler::onPreInit(nc::AppConfiguration &config)
 	config.graphics.vsync = theCfg.vsync;
 
 	config.audio.enabled = false;
-	config.jobSystem.enabled = false;
+	// Sprite grids are deformed and saved frames are encoded to PNG files by the job system
+	config.jobSystem.enabled = true;
 	config.features.debugOverlay = false;
 	config.features.scenegraph = false;
+
+	if (parseCommandLine(config))
+	{
+		// Batch rendering should never wait for the display refresh
+		config.window.title = "SpookyGhost (rendering)";
+		config.window.fullscreen = false;
+		config.graphics.frameLimit = 0;
+		config.graphics.vsync = false;
+	}
 }
 
 void MyEventHandler::onInit()
@@ -168,85 +367,82 @@ void MyEventHandler::onInit()
 	theAnimMgr = nctl::makeUnique<AnimationManager>();
 	theSaver = nctl::makeUnique<LuaSaver>(32 * 1024);
 	theScriptingMgr = nctl::makeUnique<ScriptManager>();
+	thePngSaverPool = nctl::makeUnique<PngSaverPool>(0);
+
+	if (cmdBenchmarkGrid || cmdBenchmarkEasing)
+	{
+		if (cmdBenchmarkGrid)
+			Benchmarks::gridKernels();
+		if (cmdBenchmarkEasing)
+			Benchmarks::easingCurves();
+		cmdRender.enabled = false;
+		nc::theApplication().quit();
+		return;
+	}
+
+	if (cmdRender.enabled)
+	{
+		LuaSaver::Data data(*theCanvas, *theSpriteMgr, *theScriptingMgr, *theAnimMgr);
+		if (theSaver->load(cmdRender.projectFile.data(), data) == false)
+		{
+			LOGE_X("Cannot load project file \"%s\"", cmdRender.projectFile.data());
+			cmdRender.enabled = false;
+			nc::theApplication().quit();
+		}
+		return;
+	}
 
 	ui_ = nctl::makeUnique<UserInterface>();
 }
 
 void MyEventHandler::onShutdown()
 {
+	// Pending encoding jobs must finish before the job system is destroyed
+	thePngSaverPool.reset(nullptr);
 	RenderingResources::dispose();
 }
 
 void MyEventHandler::onFrameStart()
 {
-	const float frameTime = nc::theApplication().frameTime();
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-	theCanvas->bind();
-
-	const SaveAnim &saveAnimStatus = ui_->saveAnimStatus();
-	if (ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet())
+	if (ui_ == nullptr)
 	{
-		if (saveAnimStatus.numSavedFrames == 0)
+		// The user interface is not created when rendering from the command line
+		if (cmdRender.enabled)
 		{
-			// Reset to initial state before playing
-			theAnimMgr->stop();
-			theAnimMgr->play();
-			theAnimMgr->update(0.0f);
+			renderFromCommandLine();
+			cmdRender.enabled = false;
 		}
+		nc::theApplication().quit();
+		return;
 	}
-	else
-		theAnimMgr->update(frameTime);
-	theSpriteMgr->update();
 
-	theCanvas->unbind();
+	const float frameTime = nc::theApplication().frameTime();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
 	if (ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet())
 	{
-		Canvas *sourceCanvas = (saveAnimStatus.canvasResize != 1.0f) ? theResizedCanvas.get() : theCanvas.get();
-
-		if (saveAnimStatus.numSavedFrames == 0 && ui_->shouldSaveSpritesheet())
+		// Render as many frames as the time budget allows, then let the interface update
+		const nc::TimeStamp batchStart = nc::TimeStamp::now();
+		do
 		{
-			theSpritesheet->bindDraw();
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-		}
+			saveAnimFrame();
+		} while ((ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet()) && batchStart.millisecondsSince() < SaveAnimBatchBudgetMs);
+	}
+	else
+	{
+		// Drop the readbacks that were still in flight when the render has been cancelled
+		theCanvas->discardSaves();
+		theResizedCanvas->discardSaves();
 
-		if (saveAnimStatus.canvasResize != 1.0f)
+		if (ui_->isScrubbing())
+			ui_->renderScrubbedFrame();
+		else
 		{
-			theCanvas->bindRead();
-			theResizedCanvas->bindDraw();
-			glBlitFramebuffer(0, 0, theCanvas->texWidth(), theCanvas->texHeight(), 0, 0, theResizedCanvas->texWidth(), theResizedCanvas->texHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			theCanvas->bind();
+			theAnimMgr->update(frameTime);
+			theSpriteMgr->update();
 			theCanvas->unbind();
-			theResizedCanvas->unbind();
-		}
-
-		if (ui_->shouldSaveFrames())
-			sourceCanvas->save(saveAnimStatus.filename.data());
-		else if (ui_->shouldSaveSpritesheet())
-		{
-			sourceCanvas->bindRead();
-			theSpritesheet->bindTexture();
-			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, saveAnimStatus.sheetDestPos.x, saveAnimStatus.sheetDestPos.y, 0, 0, sourceCanvas->texWidth(), sourceCanvas->texHeight());
-			sourceCanvas->unbind();
-			theSpritesheet->unbindTexture();
 		}
-
-		const bool shouldSaveBefore = (ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet());
-		const bool shouldSaveSpritesheetBefore = ui_->shouldSaveSpritesheet();
-		ui_->signalFrameSaved();
-		const bool shouldSaveAfter = (ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet());
-		// Check if this was the last frame
-		if (shouldSaveBefore != shouldSaveAfter)
-		{
-			if (shouldSaveSpritesheetBefore)
-				theSpritesheet->save(saveAnimStatus.filename.data());
-			// Stop animations after the saving process is complete
-			theAnimMgr->stop();
-			// Notify the user about the end of the saving process on desktop platforms
-			nc::theApplication().gfxDevice().flashWindow();
-		}
-		else
-			theAnimMgr->update(saveAnimStatus.inverseFps());
 	}
 
 	ui_->createGui();
@@ -254,6 +450,9 @@ void MyEventHandler::onFrameStart()
 
 void MyEventHandler::onChangeScalingFactor(float factor)
 {
+	if (ui_ == nullptr)
+		return;
+
 	if (theCfg.autoGuiScaling)
 	{
 		ui_->changeScalingFactor(factor);
@@ -263,6 +462,9 @@ void MyEventHandler::onChangeScalingFactor(float factor)
 
 void MyEventHandler::onKeyPressed(const nc::KeyboardEvent &event)
 {
+	if (ui_ == nullptr)
+		return;
+
 	if (event.mod & nc::KeyMod::CTRL)
 	{
 		if (event.sym == nc::KeySym::N && ui_->menuNewEnabled())
@@ -299,6 +501,9 @@ void MyEventHandler::onKeyPressed(const nc::KeyboardEvent &event)
 
 void MyEventHandler::onKeyReleased(const nc::KeyboardEvent &event)
 {
+	if (ui_ == nullptr)
+		return;
+
 	if (event.sym == nc::KeySym::ESCAPE)
 	{
 		ui_->closeModalsAndUndockables();
@@ -316,7 +521,75 @@ void MyEventHandler::onFilesDropped(const nc::DropEvent &event)
 
 bool MyEventHandler::onQuitRequest()
 {
+	if (ui_ == nullptr)
+		return true;
+
 	ui_->quit();
 	// Ignore the quit request
 	return false;
 }
+
+void MyEventHandler::saveAnimFrame()
+{
+	const SaveAnim &saveAnimStatus = ui_->saveAnimStatus();
+
+	theCanvas->bind();
+	if (saveAnimStatus.numSavedFrames == 0)
+	{
+		// Reset to initial state before playing
+		theAnimMgr->stop();
+		theAnimMgr->play();
+		theAnimMgr->update(0.0f);
+	}
+	theSpriteMgr->update();
+	theCanvas->unbind();
+
+	Canvas *sourceCanvas = (saveAnimStatus.canvasResize != 1.0f) ? theResizedCanvas.get() : theCanvas.get();
+
+	if (saveAnimStatus.numSavedFrames == 0 && ui_->shouldSaveSpritesheet())
+	{
+		theSpritesheet->bindDraw();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	}
+
+	if (saveAnimStatus.canvasResize != 1.0f)
+	{
+		theCanvas->bindRead();
+		theResizedCanvas->bindDraw();
+		glBlitFramebuffer(0, 0, theCanvas->texWidth(), theCanvas->texHeight(), 0, 0, theResizedCanvas->texWidth(), theResizedCanvas->texHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		theCanvas->unbind();
+		theResizedCanvas->unbind();
+	}
+
+	if (ui_->shouldSaveFrames())
+		sourceCanvas->save(saveAnimStatus.filename.data(), *thePngSaverPool);
+	else if (ui_->shouldSaveSpritesheet())
+	{
+		sourceCanvas->bindRead();
+		theSpritesheet->bindTexture();
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, saveAnimStatus.sheetDestPos.x, saveAnimStatus.sheetDestPos.y, 0, 0, sourceCanvas->texWidth(), sourceCanvas->texHeight());
+		sourceCanvas->unbind();
+		theSpritesheet->unbindTexture();
+	}
+
+	const bool shouldSaveSpritesheetBefore = ui_->shouldSaveSpritesheet();
+	ui_->signalFrameSaved();
+	const bool shouldSaveAfter = (ui_->shouldSaveFrames() || ui_->shouldSaveSpritesheet());
+	// Check if this was the last frame
+	if (shouldSaveAfter == false)
+	{
+		if (shouldSaveSpritesheetBefore)
+			theSpritesheet->save(saveAnimStatus.filename.data());
+		else
+		{
+			sourceCanvas->finishSaves(*thePngSaverPool);
+			thePngSaverPool->waitAll();
+		}
+		// Stop animations after the saving process is complete
+		theAnimMgr->stop();
+		// Notify the user about the end of the saving process on desktop platforms
+		nc::theApplication().gfxDevice().flashWindow();
+	}
+	else
+		theAnimMgr->update(saveAnimStatus.inverseFps());
+}
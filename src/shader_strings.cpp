@@ -81,3 +81,105 @@ void main()
 	vColor = color;
 }
 )glsl";
+
+char const *const ShaderStrings::meshsprite_grid_vs = R"glsl(
+#define MAX_GRID_FUNCTIONS 8
+#define WAVE_X 0
+#define WAVE_Y 1
+#define SKEW_X 2
+#define SKEW_Y 3
+#define ZOOM 4
+
+uniform mat4 projection;
+uniform mat4 modelView;
+uniform vec4 color;
+uniform vec4 texRect;
+uniform vec2 spriteSize;
+uniform int numGridFunctions;
+// Two vectors per function: (id, curve value, unused, unused) and (param0, param1, param2, unused)
+uniform vec4 gridFunctions[MAX_GRID_FUNCTIONS * 2];
+in vec2 aPosition;
+in vec2 aTexCoords;
+out vec2 vTexCoords;
+out vec4 vColor;
+
+const float PI = 3.14159265358979;
+
+void main()
+{
+	// Rest texel coordinates of the vertex, as used by the CPU grid functions
+	vec2 texel = aTexCoords * spriteSize;
+	vec2 halfSize = floor(spriteSize * 0.5);
+	vec2 offset = vec2(0.0, 0.0);
+
+	for (int i = 0; i < numGridFunctions; i++)
+	{
+		int id = int(gridFunctions[i * 2].x);
+		float value = gridFunctions[i * 2].y;
+		vec4 params = gridFunctions[i * 2 + 1];
+
+		if (id == WAVE_X)
+		{
+			float distPyNorm = (halfSize.y + params.z - texel.y) / halfSize.y;
+			offset.x += distPyNorm * params.x * sin(value * 2.0 * PI + (params.y * distPyNorm));
+		}
+		else if (id == WAVE_Y)
+		{
+			float distPxNorm = (halfSize.x + params.z - texel.x) / halfSize.x;
+			offset.y += distPxNorm * params.x * sin(value * 2.0 * PI + (params.y * distPxNorm));
+		}
+		else if (id == SKEW_X)
+			offset.x -= (halfSize.y + params.x - texel.y) * value / spriteSize.x;
+		else if (id == SKEW_Y)
+			offset.y -= (halfSize.x + params.x - texel.x) * value / spriteSize.y;
+		else if (id == ZOOM)
+		{
+			offset.x -= (halfSize.x + params.x - texel.x) * value / spriteSize.x;
+			offset.y -= (halfSize.y + params.y - texel.y) * value / spriteSize.y;
+		}
+	}
+
+	vec4 position = vec4((aPosition.x + offset.x) * spriteSize.x, (aPosition.y + offset.y) * spriteSize.y, 0.0, 1.0);
+	gl_Position = projection * modelView * position;
+	vTexCoords = vec2(aTexCoords.x * texRect.x + texRect.y, aTexCoords.y * texRect.z + texRect.w);
+	vColor = color;
+}
+)glsl";
+
+char const *const ShaderStrings::batchedsprites_vs = R"glsl(
+uniform mat4 projection;
+in vec2 aPosition;
+in vec2 aTexCoords;
+in vec4 aColor;
+out vec2 vTexCoords;
+out vec4 vColor;
+
+void main()
+{
+	gl_Position = projection * vec4(aPosition, 0.0, 1.0);
+	vTexCoords = aTexCoords;
+	vColor = aColor;
+}
+)glsl";
+
+char const *const ShaderStrings::instancedsprites_vs = R"glsl(
+uniform mat4 projection;
+in vec4 aTransform;
+in vec4 aPositionSize;
+in vec4 aTexRect;
+in vec4 aColor;
+out vec2 vTexCoords;
+out vec4 vColor;
+
+void main()
+{
+	vec2 corner = vec2(0.5 - float(gl_VertexID >> 1), -0.5 + float(gl_VertexID % 2));
+	vec2 local = corner * aPositionSize.zw;
+	vec2 position = vec2(aTransform.x * local.x + aTransform.z * local.y, aTransform.y * local.x + aTransform.w * local.y);
+	vec2 texCoords = corner + vec2(0.5, 0.5);
+
+	gl_Position = projection * vec4(position + aPositionSize.xy, 0.0, 1.0);
+	vTexCoords = vec2(texCoords.x * aTexRect.x + aTexRect.y, texCoords.y * aTexRect.z + aTexRect.w);
+	vColor = aColor;
+}
+)glsl";
@@ -8,3 +8,4 @@ nctl::UniquePtr<SpriteManager> theSpriteMgr;
 nctl::UniquePtr<AnimationManager> theAnimMgr;
 nctl::UniquePtr<LuaSaver> theSaver;
 nctl::UniquePtr<ScriptManager> theScriptingMgr;
+nctl::UniquePtr<PngSaverPool> thePngSaverPool;